@@ -32,6 +32,7 @@ TH1 *ClientHistoList::Histo() const
 void ClientHistoList::Histo(TH1 *Histo)
 {
   histo = Histo;
+  updates++;
   return;
 }
 
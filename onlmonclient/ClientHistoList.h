@@ -22,11 +22,17 @@ class ClientHistoList
   void SubSystem(const std::string &SubSystem);
   void ServerPort(const int port);
   int ServerPort() const;
+  void Version(const unsigned int i) { version = i; }
+  unsigned int Version() const { return version; }
+  // counts how often the histogram was replaced, 0: never set
+  unsigned int Updates() const { return updates; }
   void identify(std::ostream &os = std::cout) const;
 
  protected:
   TH1 *histo;
   int serverport;
+  unsigned int version = 0;
+  unsigned int updates = 0;
   std::string serverhost;
   std::string subsystem;
 };
@@ -0,0 +1,171 @@
+#include "ClientHistoPrefetch.h"
+#include "OnlMonClient.h"
+
+#include <TH1.h>
+
+#include <iostream>
+#include <vector>
+
+ClientHistoPrefetch::~ClientHistoPrefetch()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stop = true;
+  }
+  cv.notify_all();
+  if (worker.joinable())
+  {
+    worker.join();
+  }
+  for (auto &result : done)
+  {
+    for (auto &hiter : result.second.histos)
+    {
+      delete hiter.second;
+    }
+  }
+}
+
+void ClientHistoPrefetch::Schedule(const std::list<Request> &requests)
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    pending = requests;
+    if (!worker.joinable())
+    {
+      worker = std::thread(&ClientHistoPrefetch::Run, this);
+    }
+  }
+  cv.notify_all();
+  return;
+}
+
+int ClientHistoPrefetch::Take(const std::string &subsys, Result &result, const int maxage)
+{
+  std::unique_lock<std::mutex> lock(mtx);
+  // the caller fetches this one itself now
+  pending.remove_if([&subsys](const Request &request)
+                    { return request.subsys == subsys; });
+  // do not block the gui while it is in flight
+  if (busy == subsys)
+  {
+    discard.insert(subsys);
+    return -1;
+  }
+  auto resiter = done.find(subsys);
+  if (resiter == done.end())
+  {
+    return -1;
+  }
+  Result found = resiter->second;
+  done.erase(resiter);
+  if (time(nullptr) - found.fetchtime > maxage)
+  {
+    if (verbosity > 0)
+    {
+      std::cout << "prefetched histograms of " << subsys << " are too old, discarding them" << std::endl;
+    }
+    for (auto &hiter : found.histos)
+    {
+      delete hiter.second;
+    }
+    return -1;
+  }
+  result = found;
+  return 0;
+}
+
+void ClientHistoPrefetch::Run()
+{
+  std::unique_lock<std::mutex> lock(mtx);
+  while (true)
+  {
+    cv.wait(lock, [this]
+            { return stop || !pending.empty(); });
+    if (stop)
+    {
+      break;
+    }
+    Request request = pending.front();
+    pending.pop_front();
+    busy = request.subsys;
+    lock.unlock();
+    Fetch(request);
+    lock.lock();
+    // the client fetched them itself meanwhile, ours are older
+    if (discard.erase(request.subsys))
+    {
+      auto resiter = done.find(request.subsys);
+      if (resiter != done.end())
+      {
+        for (auto &hiter : resiter->second.histos)
+        {
+          delete hiter.second;
+        }
+        done.erase(resiter);
+      }
+    }
+    busy.clear();
+    cv.notify_all();
+  }
+  return;
+}
+
+void ClientHistoPrefetch::Fetch(const Request &request)
+{
+  std::map<std::string, unsigned int> serverversions;
+  int haveversions = (OnlMonClient::fetchHistoVersions(request.hostname, request.port, request.subsys, serverversions, verbosity) == 0);
+  std::list<std::string> histolist;
+  for (auto &hiter : request.versions)
+  {
+    if (haveversions && hiter.second > 0)
+    {
+      auto veriter = serverversions.find(hiter.first);
+      if (veriter != serverversions.end() && veriter->second == hiter.second)
+      {
+        continue;
+      }
+    }
+    histolist.push_back(request.subsys + ' ' + hiter.first);
+  }
+  Result result;
+  result.fetchtime = time(nullptr);
+  for (auto &hname : histolist)
+  {
+    result.requested.insert(hname.substr(hname.find(' ') + 1));
+  }
+  std::vector<TH1 *> histos;
+  if (!histolist.empty() &&
+      OnlMonClient::fetchHistoList(request.hostname, request.port, histolist, histos, verbosity))
+  {
+    // let the client try again itself
+    for (auto histo : histos)
+    {
+      delete histo;
+    }
+    return;
+  }
+  for (auto histo : histos)
+  {
+    histo->SetDirectory(nullptr);
+    result.histos[histo->GetName()] = histo;
+    auto veriter = serverversions.find(histo->GetName());
+    result.versions[histo->GetName()] = (veriter != serverversions.end()) ? veriter->second : 0;
+  }
+  if (verbosity > 0)
+  {
+    std::cout << "prefetched " << result.histos.size() << " of " << request.versions.size()
+              << " histograms of " << request.subsys << std::endl;
+  }
+  std::lock_guard<std::mutex> lock(mtx);
+  auto resiter = done.find(request.subsys);
+  if (resiter != done.end())
+  {
+    for (auto &hiter : resiter->second.histos)
+    {
+      delete hiter.second;
+    }
+  }
+  done[request.subsys] = result;
+  return;
+}
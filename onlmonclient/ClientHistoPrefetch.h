@@ -0,0 +1,79 @@
+#ifndef CLIENTHISTOPREFETCH_H__
+#define CLIENTHISTOPREFETCH_H__
+
+#include <condition_variable>
+#include <ctime>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+class TH1;
+
+/**
+Fetches the histograms of monitors in a background thread, so a
+GUI can ask for the monitors it is going to show next and only
+draws once it gets there. The thread only talks to the servers,
+the fetched histograms are handed over to the client in Take()
+which is called from the thread owning the client (requests are
+built there as well, the thread does not touch any client data).
+ROOT::EnableThreadSafety() has to be called by the program at startup,
+before any other thread exists.
+*/
+
+class ClientHistoPrefetch
+{
+ public:
+  struct Request
+  {
+    std::string subsys;
+    std::string hostname;
+    int port = 0;
+    // registered histograms and the versions the client has (0: none)
+    std::map<std::string, unsigned int> versions;
+  };
+
+  struct Result
+  {
+    std::map<std::string, TH1 *> histos;
+    std::map<std::string, unsigned int> versions;
+    // histograms asked for, the ones missing in histos are not on the server
+    std::set<std::string> requested;
+    time_t fetchtime = 0;
+  };
+
+  ClientHistoPrefetch() = default;
+  virtual ~ClientHistoPrefetch();
+
+  // delete copy ctor and assignment operator (cppcheck)
+  explicit ClientHistoPrefetch(const ClientHistoPrefetch &) = delete;
+  ClientHistoPrefetch &operator=(const ClientHistoPrefetch &) = delete;
+
+  //! replaces the requests which are not yet started
+  void Schedule(const std::list<Request> &requests);
+  //! hands over the histograms fetched for subsys if they are not older
+  //! than maxage seconds. Returns 0 if there was a result, the caller owns
+  //! the histograms. It does not wait for subsys if it is being fetched right
+  //! now, that result is dropped and the caller fetches it itself
+  int Take(const std::string &subsys, Result &result, const int maxage);
+  void Verbosity(const int i) { verbosity = i; }
+
+ protected:
+  void Run();
+  void Fetch(const Request &request);
+
+  int verbosity = 0;
+  bool stop = false;
+  std::string busy;
+  // in flight when the caller gave up on it
+  std::set<std::string> discard;
+  std::list<Request> pending;
+  std::map<std::string, Result> done;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::thread worker;
+};
+
+#endif /* CLIENTHISTOPREFETCH_H__ */
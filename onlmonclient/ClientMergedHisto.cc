@@ -0,0 +1,337 @@
+#include "ClientMergedHisto.h"
+#include "ClientHistoList.h"
+
+#include <TArray.h>
+#include <TArrayC.h>
+#include <TArrayD.h>
+#include <TArrayF.h>
+#include <TArrayI.h>
+#include <TArrayL64.h>
+#include <TArrayS.h>
+#include <TH1.h>
+
+#include <algorithm>
+#include <thread>
+
+ClientMergedHisto::ClientMergedHisto(const std::string &hname, const MergeOp op)
+  : operation(op)
+  , name(hname)
+{
+}
+
+ClientMergedHisto::~ClientMergedHisto()
+{
+  delete histo;
+}
+
+void ClientMergedHisto::AddSource(const std::string &subsys, const std::string &hname)
+{
+  for (auto &src : sources)
+  {
+    if (src.first == subsys && src.second == hname)
+    {
+      return;
+    }
+  }
+  sources.emplace_back(subsys, hname);
+  states.clear();  // force a new merge
+  return;
+}
+
+TH1 *ClientMergedHisto::Update(const std::vector<const ClientHistoList *> &srclist)
+{
+  std::vector<TH1 *> srchistos(srclist.size(), nullptr);
+  std::vector<unsigned int> updates(srclist.size(), 0);
+  for (unsigned int k = 0; k < srclist.size(); k++)
+  {
+    if (srclist[k] && srclist[k]->Histo())
+    {
+      srchistos[k] = srclist[k]->Histo();
+      updates[k] = srclist[k]->Updates();
+    }
+  }
+  bool rebuild = (!histo || states.size() != srclist.size());
+  std::vector<unsigned int> changed;
+  for (unsigned int k = 0; k < srclist.size() && !rebuild; k++)
+  {
+    // a source which appeared or went away changes the number of sources
+    if ((updates[k] == 0) != (states[k].updates == 0))
+    {
+      rebuild = true;
+    }
+    else if (updates[k] != states[k].updates)
+    {
+      changed.push_back(k);
+    }
+  }
+  if (!rebuild && changed.empty())
+  {
+    return histo;
+  }
+  int iret = 0;
+  if (rebuild || !dynamic_cast<TArray *>(histo))
+  {
+    iret = Rebuild(srchistos, changed);
+  }
+  else
+  {
+    iret = MergeChanged(srchistos, changed);
+    if (iret == 1)
+    {
+      // a source got a different binning
+      iret = Rebuild(srchistos, changed);
+    }
+  }
+  if (iret)
+  {
+    std::cout << __PRETTY_FUNCTION__ << " could not merge " << name << std::endl;
+    delete histo;
+    histo = nullptr;
+    states.clear();
+    return histo;
+  }
+  for (unsigned int k = 0; k < srclist.size(); k++)
+  {
+    states[k].updates = updates[k];
+  }
+  return histo;
+}
+
+int ClientMergedHisto::Rebuild(const std::vector<TH1 *> &srchistos, std::vector<unsigned int> &changed)
+{
+  delete histo;
+  histo = nullptr;
+  states.assign(srchistos.size(), SourceState());
+  changed.clear();
+  std::vector<TH1 *> present;
+  for (unsigned int k = 0; k < srchistos.size(); k++)
+  {
+    if (srchistos[k])
+    {
+      present.push_back(srchistos[k]);
+      changed.push_back(k);
+    }
+  }
+  if (present.empty())
+  {
+    return 0;
+  }
+  histo = static_cast<TH1 *>(present[0]->Clone(name.c_str()));
+  histo->SetDirectory(nullptr);
+  if (!dynamic_cast<TArray *>(histo))
+  {
+    return ReduceAdd(present);
+  }
+  // the errors are only merged if all sources have them
+  errors = true;
+  for (auto h : present)
+  {
+    if (h->GetSumw2N() != histo->GetNcells())
+    {
+      errors = false;
+    }
+  }
+  histo->Reset();
+  if (!errors)
+  {
+    histo->GetSumw2()->Set(0);
+  }
+  if (MergeChanged(srchistos, changed))
+  {
+    std::cout << __PRETTY_FUNCTION__ << " the sources of " << name
+              << " do not have the same binning" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+int ClientMergedHisto::MergeChanged(const std::vector<TH1 *> &srchistos, const std::vector<unsigned int> &changed)
+{
+  int iret = -1;
+  if (dynamic_cast<TArrayD *>(histo))
+  {
+    iret = MergeBins<TArrayD>(srchistos, changed);
+  }
+  else if (dynamic_cast<TArrayF *>(histo))
+  {
+    iret = MergeBins<TArrayF>(srchistos, changed);
+  }
+  else if (dynamic_cast<TArrayI *>(histo))
+  {
+    iret = MergeBins<TArrayI>(srchistos, changed);
+  }
+  else if (dynamic_cast<TArrayS *>(histo))
+  {
+    iret = MergeBins<TArrayS>(srchistos, changed);
+  }
+  else if (dynamic_cast<TArrayC *>(histo))
+  {
+    iret = MergeBins<TArrayC>(srchistos, changed);
+  }
+  else if (dynamic_cast<TArrayL64 *>(histo))
+  {
+    iret = MergeBins<TArrayL64>(srchistos, changed);
+  }
+  if (iret)
+  {
+    return iret;
+  }
+  double entries = 0;
+  double nsrc = 0;
+  for (auto h : srchistos)
+  {
+    if (h)
+    {
+      entries = (operation == MAX) ? std::max(entries, h->GetEntries()) : entries + h->GetEntries();
+      nsrc++;
+    }
+  }
+  if (operation == AVERAGE)
+  {
+    entries /= nsrc;
+  }
+  histo->ResetStats();
+  histo->SetEntries(entries);
+  return 0;
+}
+
+template <class T>
+int ClientMergedHisto::MergeBins(const std::vector<TH1 *> &srchistos, const std::vector<unsigned int> &changed)
+{
+  T *dest = dynamic_cast<T *>(histo);
+  double *destw2 = (errors) ? histo->GetSumw2()->fArray : nullptr;
+  const int ncells = dest->fN;
+  std::vector<const T *> src;
+  std::vector<const double *> srcw2;
+  for (auto h : srchistos)
+  {
+    if (!h)
+    {
+      continue;
+    }
+    const T *arr = dynamic_cast<const T *>(h);
+    if (!arr || arr->fN != ncells || (errors && h->GetSumw2N() != ncells))
+    {
+      return 1;
+    }
+    src.push_back(arr);
+    srcw2.push_back((errors) ? h->GetSumw2()->fArray : nullptr);
+  }
+  const double nsrc = src.size();
+  const MergeOp op = operation;
+  // merged value of one bin from all sources
+  auto mergebin = [&src, &srcw2, dest, destw2, nsrc, op](const int bin)
+  {
+    double val = src[0]->fArray[bin];
+    double w2 = (destw2) ? srcw2[0][bin] : 0;
+    for (unsigned int k = 1; k < src.size(); k++)
+    {
+      double v = src[k]->fArray[bin];
+      if (op == MAX)
+      {
+        if (v > val)
+        {
+          val = v;
+          w2 = (destw2) ? srcw2[k][bin] : 0;
+        }
+      }
+      else
+      {
+        val += v;
+        w2 += (destw2) ? srcw2[k][bin] : 0;
+      }
+    }
+    if (op == AVERAGE)
+    {
+      val /= nsrc;
+      w2 /= (nsrc * nsrc);
+    }
+    dest->fArray[bin] = val;
+    if (destw2)
+    {
+      destw2[bin] = w2;
+    }
+  };
+  int nthreads = 1;
+  if (ncells >= PARALLELCELLS)
+  {
+    nthreads = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, 8);
+  }
+  const int chunk = (ncells + nthreads - 1) / nthreads;
+  for (unsigned int k : changed)
+  {
+    const T *arr = dynamic_cast<const T *>(srchistos[k]);
+    const double *arrw2 = (errors) ? srchistos[k]->GetSumw2()->fArray : nullptr;
+    const std::vector<int> &oldbins = states[k].bins;
+    std::vector<std::vector<int>> newbins(nthreads);
+    // bins the source filled before (they might be empty now) and the ones it fills now
+    auto mergechunk = [&](const int ithread)
+    {
+      const int first = std::min(ithread * chunk, ncells);
+      const int last = std::min(first + chunk, ncells);
+      for (auto it = std::lower_bound(oldbins.begin(), oldbins.end(), first); it != oldbins.end() && *it < last; ++it)
+      {
+        mergebin(*it);
+      }
+      for (int bin = first; bin < last; bin++)
+      {
+        if (arr->fArray[bin] != 0 || (arrw2 && arrw2[bin] != 0))
+        {
+          mergebin(bin);
+          newbins[ithread].push_back(bin);
+        }
+      }
+    };
+    std::vector<std::thread> workers;
+    for (int ithread = 1; ithread < nthreads; ithread++)
+    {
+      workers.emplace_back(mergechunk, ithread);
+    }
+    mergechunk(0);
+    for (auto &worker : workers)
+    {
+      worker.join();
+    }
+    std::vector<int> &bins = states[k].bins;
+    bins.clear();
+    for (auto &part : newbins)
+    {
+      bins.insert(bins.end(), part.begin(), part.end());
+    }
+  }
+  return 0;
+}
+
+int ClientMergedHisto::ReduceAdd(const std::vector<TH1 *> &srchistos)
+{
+  // histograms without bin array (TH2Poly) only support what TH1::Add does
+  if (operation == MAX)
+  {
+    std::cout << __PRETTY_FUNCTION__ << " MAX not implemented for "
+              << histo->ClassName() << std::endl;
+    return -1;
+  }
+  for (unsigned int k = 1; k < srchistos.size(); k++)
+  {
+    if (!histo->Add(srchistos[k], 1.))
+    {
+      return -1;
+    }
+  }
+  if (operation == AVERAGE)
+  {
+    histo->Scale(1. / srchistos.size());
+  }
+  return 0;
+}
+
+void ClientMergedHisto::identify(std::ostream &os) const
+{
+  os << "Merged Histo " << name
+     << ", operation: " << operation
+     << ", at " << histo << ", sources:" << std::endl;
+  for (auto &src : sources)
+  {
+    os << "  " << src.second << " @ " << src.first << std::endl;
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef CLIENTMERGEDHISTO_H__
+#define CLIENTMERGEDHISTO_H__
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ClientHistoList;
+class TH1;
+
+/**
+Recipe for a histogram which is merged on the client from the
+same (or equivalent) histograms of several servers (e.g. the 6
+MVTX FELIX servers or the 24 TPC servers).
+
+The merged histogram is kept between updates. When sources were
+replaced since the last merge only their bins are merged again: the
+bins which were not empty in the new or the previous version of a
+changed source are recomputed from all sources. Histograms with a bin
+array (all but TH2Poly) are handled this way, large ones are scanned in
+parallel threads. TH2Poly is rebuilt with TH1::Add, the merge is rebuilt
+as well when a source appears, disappears or its binning changed.
+*/
+
+class ClientMergedHisto
+{
+ public:
+  enum MergeOp
+  {
+    SUM = 0,
+    MAX = 1,
+    AVERAGE = 2
+  };
+
+  ClientMergedHisto(const std::string &hname, const MergeOp op = SUM);
+  virtual ~ClientMergedHisto();
+
+  // delete copy ctor and assignment operator (cppcheck)
+  explicit ClientMergedHisto(const ClientMergedHisto &) = delete;
+  ClientMergedHisto &operator=(const ClientMergedHisto &) = delete;
+
+  void AddSource(const std::string &subsys, const std::string &hname);
+  const std::vector<std::pair<std::string, std::string>> &Sources() const { return sources; }
+
+  //! merges the sources which changed since the last call, the
+  //! ClientHistoList entries have to be in the same order as Sources()
+  TH1 *Update(const std::vector<const ClientHistoList *> &srclist);
+  TH1 *Histo() const { return histo; }
+  MergeOp Operation() const { return operation; }
+  void identify(std::ostream &os = std::cout) const;
+
+  // number of cells above which a source is merged in parallel
+  static const int PARALLELCELLS = 100000;
+
+ protected:
+  // what a source contributed to the merged histogram
+  struct SourceState
+  {
+    unsigned int updates = 0;  // ClientHistoList::Updates() at the last merge, 0: not merged
+    std::vector<int> bins;     // not empty bins (content or error) in ascending order
+  };
+
+  int Rebuild(const std::vector<TH1 *> &srchistos, std::vector<unsigned int> &changed);
+  // returns 1 if the sources do not match the merged histogram anymore
+  int MergeChanged(const std::vector<TH1 *> &srchistos, const std::vector<unsigned int> &changed);
+  template <class T>
+  int MergeBins(const std::vector<TH1 *> &srchistos, const std::vector<unsigned int> &changed);
+  int ReduceAdd(const std::vector<TH1 *> &srchistos);
+
+  TH1 *histo = nullptr;
+  MergeOp operation = SUM;
+  bool errors = false;
+  std::string name;
+  std::vector<std::pair<std::string, std::string>> sources;
+  std::vector<SourceState> states;
+};
+
+#endif /* CLIENTMERGEDHISTO_H__ */
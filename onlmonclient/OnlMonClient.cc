@@ -1,14 +1,20 @@
 #include "OnlMonClient.h"
 #include "ClientHistoList.h"
+#include "ClientHistoPrefetch.h"
+#include "ClientMergedHisto.h"
 #include "OnlMonDraw.h"
+#include "OnlMonFileIndex.h"
 #include "OnlMonHtml.h"
 
 #include <onlmon/HistoBinDefs.h>
 #include <onlmon/OnlMonBase.h>  // for OnlMonBase
+#include <onlmon/OnlMonDB.h>
 #include <onlmon/OnlMonDefs.h>
+#include <onlmon/OnlMonSparse.h>
 
 #include <MessageTypes.h>  // for kMESS_STRING, kMESS_OBJECT
 #include <TCanvas.h>
+#include <TClass.h>
 #include <TDirectory.h>
 #include <TFile.h>
 #include <TGClient.h>  // for gClient, TGClient
@@ -16,6 +22,7 @@
 #include <TH1.h>
 #include <TImage.h>
 #include <TIterator.h>
+#include <TKey.h>
 #include <TList.h>  // for TList
 #include <TMessage.h>
 #include <TROOT.h>
@@ -23,6 +30,7 @@
 #include <TSocket.h>
 #include <TStyle.h>
 #include <TSystem.h>
+#include <TVirtualMutex.h>
 
 #include <odbc++/connection.h>
 #include <odbc++/drivermanager.h>
@@ -32,10 +40,10 @@
 
 #include <sys/stat.h>
 #include <sys/utsname.h>
+#include <sys/wait.h>
 #include <unistd.h>
-#include <uuid/uuid.h>
 #include <algorithm>
-#include <cstdio>   // for printf, remove
+#include <cstdio>   // for printf
 #include <cstdlib>  // for getenv, exit
 #include <cstring>  // for strcmp
 #include <filesystem>
@@ -140,6 +148,25 @@ OnlMonClient::~OnlMonClient()
     delete Histo.begin()->second;
     Histo.erase(Histo.begin());
   }
+  for (auto &subsys : SubsysMergedHisto)
+  {
+    for (auto &hiter : subsys.second)
+    {
+      delete hiter.second;
+    }
+  }
+  SubsysMergedHisto.clear();
+  while (m_LazyFiles.begin() != m_LazyFiles.end())
+  {
+    CloseLazyFile(m_LazyFiles.begin()->first);
+  }
+  for (auto &rebiniter : m_RebinnedHistos)
+  {
+    delete rebiniter.second.second;
+  }
+  m_RebinnedHistos.clear();
+  delete m_Prefetch;
+  delete m_FileIndex;
   delete clientrunning;
   delete fHtml;
   delete defaultStyle;
@@ -207,6 +234,58 @@ void OnlMonClient::registerHisto(const std::string &hname, const std::string &su
   return;
 }
 
+int OnlMonClient::registerMergedHisto(const std::string &subsys, const std::string &hname, const std::vector<std::string> &sourcesubsys, const std::string &operation)
+{
+  ClientMergedHisto::MergeOp op;
+  if (operation == "SUM")
+  {
+    op = ClientMergedHisto::SUM;
+  }
+  else if (operation == "MAX")
+  {
+    op = ClientMergedHisto::MAX;
+  }
+  else if (operation == "AVERAGE")
+  {
+    op = ClientMergedHisto::AVERAGE;
+  }
+  else
+  {
+    std::cout << "Bad merge operation " << operation
+              << ", implemented are SUM MAX AVERAGE" << std::endl;
+    return -1;
+  }
+  auto subsysiter = SubsysMergedHisto.find(subsys);
+  if (subsysiter != SubsysMergedHisto.end() && subsysiter->second.find(hname) != subsysiter->second.end())
+  {
+    std::cout << "Merged histogram " << hname << " of " << subsys
+              << " already registered, I won't overwrite it" << std::endl;
+    return -1;
+  }
+  SubsysMergedHisto[subsys][hname] = new ClientMergedHisto(hname, op);
+  for (auto &srcsubsys : sourcesubsys)
+  {
+    addMergeSource(subsys, hname, srcsubsys, hname);
+  }
+  return 0;
+}
+
+int OnlMonClient::addMergeSource(const std::string &subsys, const std::string &hname, const std::string &sourcesubsys, const std::string &sourcehname)
+{
+  auto subsysiter = SubsysMergedHisto.find(subsys);
+  if (subsysiter == SubsysMergedHisto.end() || subsysiter->second.find(hname) == subsysiter->second.end())
+  {
+    if (registerMergedHisto(subsys, hname, std::vector<std::string>()))
+    {
+      return -1;
+    }
+    subsysiter = SubsysMergedHisto.find(subsys);
+  }
+  subsysiter->second[hname]->AddSource(sourcesubsys, sourcehname);
+  registerHisto(sourcehname, sourcesubsys);
+  return 0;
+}
+
 int OnlMonClient::requestHistoBySubSystem(const std::string &subsys, int getall)
 {
   std::string mysubsys = subsys.substr(0,subsys.find('_'));
@@ -218,6 +297,12 @@ int OnlMonClient::requestHistoBySubSystem(const std::string &subsys, int getall)
 	break;
       }
   }
+  // the background thread fetched them already
+  if (getall == 1 && m_Prefetch && TakePrefetched(subsys) == 0)
+  {
+    m_MonitorFetchedSet.insert(subsys);
+    return 0;
+  }
   int iret = 0;
   std::map<const std::string, ClientHistoList *>::const_iterator histoiter;
   std::map<const std::string, ClientHistoList *>::const_iterator histonewiter;
@@ -244,6 +329,7 @@ int OnlMonClient::requestHistoBySubSystem(const std::string &subsys, int getall)
             hiter.second->Histo()->Delete();
           }
           hiter.second->Histo(nullptr);
+          hiter.second->Version(0);
         }
       }
       return iret;
@@ -278,6 +364,9 @@ int OnlMonClient::requestHistoBySubSystem(const std::string &subsys, int getall)
     std::ostringstream host_port;
 
     int failed_to_locate = 0;
+    // only transfer histograms which changed on the server since our last fetch
+    std::map<std::string, unsigned int> versions;
+    int haveversions = (requestHistoVersions(subsys, versions) == 0);
     auto subs = SubsysHisto.find(subsys);
     {
       for (auto &histos : subs->second)
@@ -290,6 +379,19 @@ int OnlMonClient::requestHistoBySubSystem(const std::string &subsys, int getall)
         {
           int unknown_histo = 0;
           std::string hname = histos.first;
+          if (haveversions && histos.second->Histo() && histos.second->Version() > 0)
+          {
+            auto veriter = versions.find(hname);
+            if (veriter != versions.end() && veriter->second == histos.second->Version())
+            {
+              if (Verbosity() > 2)
+              {
+                std::cout << "Subsystem " << subsys << " Histogram " << hname
+                          << " unchanged (version " << veriter->second << "), not fetching" << std::endl;
+              }
+              continue;
+            }
+          }
           if (histos.second->ServerHost() == "UNKNOWN")
           {
             if (!failed_to_locate)
@@ -339,7 +441,20 @@ int OnlMonClient::requestHistoBySubSystem(const std::string &subsys, int getall)
         }
         continue;
       }
-      if (requestHistoList(listiter->first, hostportiter->second.first, hostportiter->second.second, hlist) != 0)
+      if (requestHistoList(listiter->first, hostportiter->second.first, hostportiter->second.second, hlist) == 0)
+      {
+        for (auto &fullhname : hlist)
+        {
+          std::string hname = fullhname.substr(fullhname.find(' ') + 1);
+          auto veriter = versions.find(hname);
+          auto histoiter = subs->second.find(hname);
+          if (veriter != versions.end() && histoiter != subs->second.end() && histoiter->second->Histo())
+          {
+            histoiter->second->Version(veriter->second);
+          }
+        }
+      }
+      else
       {
         for (liter = hlist.begin(); liter != hlist.end(); ++liter)
         {
@@ -483,7 +598,15 @@ int OnlMonClient::MakeHtml(const char *who, const char *what)
     std::cout << "Making html output group writable so others can run tests as well" << std::endl;
   }
   fHtml->runNumber(runno);  // do not forget this !
-  int iret = DoSomething(who, what, "HTML");
+  int iret;
+  if (m_HtmlWorkers > 1 && !strcmp(who, "ALL"))
+  {
+    iret = MakeHtmlParallel(what);
+  }
+  else
+  {
+    iret = DoSomething(who, what, "HTML");
+  }
 
   if (!onlmon_real_html)
   {
@@ -493,6 +616,312 @@ int OnlMonClient::MakeHtml(const char *who, const char *what)
   return iret;
 }
 
+int OnlMonClient::MakeHtmlParallel(const std::string &what)
+{
+  // the workers are forked, they must not touch X windows of the parent
+  if (gROOT->GetListOfCanvases()->GetSize() > 0)
+  {
+    std::cout << __PRETTY_FUNCTION__ << " canvases exist, creating html output serially" << std::endl;
+    return DoSomething("ALL", what, "HTML");
+  }
+  // a fork only copies the calling thread (the prefetch thread may hold locks
+  // of ROOT or the socket it reads), the children would share the db socket
+  // and the file offsets of the lazily read histogram files
+  if (m_Prefetch || OnlMonDB::Connected() || !m_LazyFiles.empty())
+  {
+    std::cout << __PRETTY_FUNCTION__ << " histogram prefetch, db connection or lazily read files active, creating html output serially" << std::endl;
+    return DoSomething("ALL", what, "HTML");
+  }
+  // the parent decides which drawers are up to date, the workers only report
+  // back through a pipe which drawers made their html output
+  std::vector<OnlMonDraw *> drawers;
+  std::vector<std::map<std::string, unsigned int>> drawerversions;
+  std::vector<int> knowsversions;
+  for (auto &iter : DrawerList)
+  {
+    std::map<std::string, unsigned int> versions;
+    int uptodate = HtmlUpToDate(iter.second, what, versions);
+    if (uptodate > 0)
+    {
+      continue;
+    }
+    drawers.push_back(iter.second);
+    drawerversions.push_back(versions);
+    knowsversions.push_back(uptodate == 0);
+  }
+  if (drawers.empty())
+  {
+    return 0;
+  }
+  unsigned int nworkers = std::min(m_HtmlWorkers, static_cast<unsigned int>(drawers.size()));
+  std::vector<pid_t> workerpids;
+  std::vector<unsigned int> workerindex;
+  std::vector<int> workerpipes;
+  std::vector<unsigned int> notforked;
+  std::vector<int> drawerstatus(drawers.size(), -1);
+  std::cout.flush();
+  for (unsigned int iworker = 0; iworker < nworkers; iworker++)
+  {
+    int fd[2];
+    pid_t pid = -1;
+    if (pipe(fd) == 0)
+    {
+      pid = fork();
+      if (pid < 0)
+      {
+        close(fd[0]);
+        close(fd[1]);
+      }
+    }
+    if (pid < 0)
+    {
+      std::cout << __PRETTY_FUNCTION__ << " fork failed for html worker " << iworker
+                << ", doing its drawers here" << std::endl;
+      notforked.push_back(iworker);
+      continue;
+    }
+    if (pid == 0)
+    {
+      // worker: batch mode canvases, drawers iworker, iworker + nworkers, ...
+      close(fd[0]);
+      gROOT->SetBatch(kTRUE);
+      fHtml->deferMenu(iworker);
+      for (unsigned int i = iworker; i < drawers.size(); i += nworkers)
+      {
+        if (verbosity > 0)
+        {
+          std::cout << __PRETTY_FUNCTION__ << " worker " << iworker << " creating html output for "
+                    << drawers[i]->Name() << std::endl;
+        }
+        gROOT->Reset();
+        int status = drawers[i]->MakeHtml(what);
+        if (status)
+        {
+          std::cout << "subsystem " << drawers[i]->Name()
+                    << " not in root file, skipping" << std::endl;
+          DeleteCanvases();
+        }
+        if (write(fd[1], &status, sizeof(status)) != static_cast<ssize_t>(sizeof(status)))
+        {
+          std::cout << __PRETTY_FUNCTION__ << " worker " << iworker << " cannot report the status of "
+                    << drawers[i]->Name() << std::endl;
+        }
+        SetStyleToDefault();
+      }
+      close(fd[1]);
+      int iret = fHtml->writeDeferredMenu();
+      std::cout.flush();
+      // no exit(), the parent owns the X connection and the open files
+      _exit((iret) ? 1 : 0);
+    }
+    close(fd[1]);
+    workerpids.push_back(pid);
+    workerindex.push_back(iworker);
+    workerpipes.push_back(fd[0]);
+  }
+  int iret = 0;
+  for (unsigned int ipid = 0; ipid < workerpids.size(); ipid++)
+  {
+    // the statuses in the order of the drawers of this worker, a crashed worker leaves the rest at -1
+    for (unsigned int i = workerindex[ipid]; i < drawers.size(); i += nworkers)
+    {
+      int status;
+      if (read(workerpipes[ipid], &status, sizeof(status)) != static_cast<ssize_t>(sizeof(status)))
+      {
+        break;
+      }
+      drawerstatus[i] = status;
+    }
+    close(workerpipes[ipid]);
+    int status = 0;
+    if (waitpid(workerpids[ipid], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+      std::cout << __PRETTY_FUNCTION__ << " html worker " << workerpids[ipid] << " failed" << std::endl;
+      iret = -1;
+    }
+  }
+  fHtml->mergeWorkerMenus(nworkers);
+  for (auto inotforked : notforked)
+  {
+    for (unsigned int i = inotforked; i < drawers.size(); i += nworkers)
+    {
+      gROOT->Reset();
+      drawerstatus[i] = drawers[i]->MakeHtml(what);
+      if (drawerstatus[i])
+      {
+        std::cout << "subsystem " << drawers[i]->Name()
+                  << " not in root file, skipping" << std::endl;
+        DeleteCanvases();
+      }
+      SetStyleToDefault();
+    }
+  }
+  for (unsigned int i = 0; i < drawers.size(); i++)
+  {
+    if (knowsversions[i])
+    {
+      HtmlDone(drawers[i], what, drawerversions[i], drawerstatus[i]);
+    }
+  }
+  return iret;
+}
+
+int OnlMonClient::HtmlUpToDate(OnlMonDraw *drawer, const std::string &what, std::map<std::string, unsigned int> &versions)
+{
+  if (!m_HtmlIncremental)
+  {
+    return -1;
+  }
+  // only drawers which know all their inputs can be skipped, others may
+  // show db trends, the time or dead servers which are not in any histogram
+  if (drawer->HistoVersions(what, versions))
+  {
+    return -1;
+  }
+  std::string key = drawer->Name() + '/' + what;
+  auto depiter = m_HtmlDependencies.find(key);
+  if (depiter != m_HtmlDependencies.end() && depiter->second.first == RunNumber() && depiter->second.second == versions)
+  {
+    if (verbosity > 0)
+    {
+      std::cout << __PRETTY_FUNCTION__ << " histograms of " << drawer->Name()
+                << " unchanged, not recreating html output" << std::endl;
+    }
+    return 1;
+  }
+  return 0;
+}
+
+void OnlMonClient::HtmlDone(OnlMonDraw *drawer, const std::string &what, const std::map<std::string, unsigned int> &versions, const int status)
+{
+  std::string key = drawer->Name() + '/' + what;
+  if (status)
+  {
+    m_HtmlDependencies.erase(key);
+  }
+  else
+  {
+    m_HtmlDependencies[key] = std::make_pair(RunNumber(), versions);
+  }
+  return;
+}
+
+int OnlMonClient::DrawerMakeHtml(OnlMonDraw *drawer, const std::string &what)
+{
+  std::map<std::string, unsigned int> versions;
+  int uptodate = HtmlUpToDate(drawer, what, versions);
+  if (uptodate > 0)
+  {
+    return 0;
+  }
+  int iret = drawer->MakeHtml(what);
+  if (uptodate == 0)
+  {
+    HtmlDone(drawer, what, versions, iret);
+  }
+  return iret;
+}
+
+int OnlMonClient::DrawerDraw(OnlMonDraw *drawer, const std::string &what)
+{
+  if (!m_DrawIncremental)
+  {
+    return drawer->Draw(what);
+  }
+  // only drawers which know all their inputs can be skipped, others may
+  // show db trends, the time or dead servers which are not in any histogram
+  std::map<std::string, unsigned int> versions;
+  if (drawer->HistoVersions(what, versions))
+  {
+    return drawer->Draw(what);
+  }
+  std::string key = drawer->Name() + '/' + what;
+  TSeqCollection *allCanvases = gROOT->GetListOfCanvases();
+  auto depiter = m_DrawDependencies.find(key);
+  if (depiter != m_DrawDependencies.end() && versions == depiter->second.first && !depiter->second.second.empty())
+  {
+    bool unchanged = true;
+    for (auto &cname : depiter->second.second)
+    {
+      if (!allCanvases->FindObject(cname.c_str()))
+      {
+        unchanged = false;
+        break;
+      }
+    }
+    if (unchanged)
+    {
+      if (verbosity > 0)
+      {
+        std::cout << __PRETTY_FUNCTION__ << " histograms of " << key
+                  << " unchanged, not redrawing" << std::endl;
+      }
+      return 0;
+    }
+  }
+  std::set<std::string> oldcanvases;
+  for (TObject *canvas : *allCanvases)
+  {
+    oldcanvases.insert(canvas->GetName());
+  }
+  int iret = drawer->Draw(what);
+  if (iret)
+  {
+    m_DrawDependencies.erase(key);
+    return iret;
+  }
+  // the canvases this drawer made, if it reused existing ones keep what we had
+  std::set<std::string> newcanvases;
+  std::set<std::string> allnames;
+  for (TObject *canvas : *allCanvases)
+  {
+    allnames.insert(canvas->GetName());
+    if (oldcanvases.find(canvas->GetName()) == oldcanvases.end())
+    {
+      newcanvases.insert(canvas->GetName());
+    }
+  }
+  auto &dependency = m_DrawDependencies[key];
+  dependency.first = versions;
+  if (!newcanvases.empty())
+  {
+    dependency.second = newcanvases;
+  }
+  else if (dependency.second.empty())
+  {
+    dependency.second = allnames;
+  }
+  return iret;
+}
+
+unsigned int OnlMonClient::HistoUpdates(const std::string &monitor, const std::string &hname)
+{
+  auto subsysiter = SubsysHisto.find(monitor);
+  if (subsysiter != SubsysHisto.end())
+  {
+    auto hiter = subsysiter->second.find(hname);
+    if (hiter != subsysiter->second.end())
+    {
+      return hiter->second->Updates();
+    }
+  }
+  // merged histograms change when one of their sources was updated
+  unsigned int updates = 0;
+  auto mergediter = SubsysMergedHisto.find(monitor);
+  if (mergediter != SubsysMergedHisto.end())
+  {
+    auto hiter = mergediter->second.find(hname);
+    if (hiter != mergediter->second.end())
+    {
+      for (auto &src : hiter->second->Sources())
+      {
+        updates += HistoUpdates(src.first, src.second);
+      }
+    }
+  }
+  return updates;
+}
+
 int OnlMonClient::DoSomething(const std::string &who, const std::string &what, const std::string &opt)
 {
   std::map<const std::string, OnlMonDraw *>::iterator iter;
@@ -503,7 +932,7 @@ int OnlMonClient::DoSomething(const std::string &who, const std::string &what, c
     {
       if (opt == "DRAW")
       {
-        iter->second->Draw(what);
+        DrawerDraw(iter->second, what);
       }
       else if (opt == "PS")
       {
@@ -520,7 +949,7 @@ int OnlMonClient::DoSomething(const std::string &who, const std::string &what, c
           std::cout << __PRETTY_FUNCTION__ << " creating html output for "
                     << iter->second->Name() << std::endl;
         }
-        if (iter->second->MakeHtml(what))
+        if (DrawerMakeHtml(iter->second, what))
         {
           std::cout << "subsystem " << iter->second->Name()
                     << " not in root file, skipping" << std::endl;
@@ -547,7 +976,7 @@ int OnlMonClient::DoSomething(const std::string &who, const std::string &what, c
     {
       if (opt == "DRAW")
       {
-        iter->second->Draw(what);
+        DrawerDraw(iter->second, what);
       }
       else if (opt == "PS")
       {
@@ -561,21 +990,14 @@ int OnlMonClient::DoSomething(const std::string &who, const std::string &what, c
                     << iter->second->Name() << std::endl;
         }
         gROOT->Reset();
-        int iret = iter->second->MakeHtml(what);
+        int iret = DrawerMakeHtml(iter->second, what);
         if (iret)
         {
           std::cout << "subsystem " << iter->second->Name()
                     << " not in root file, skipping" << std::endl;
-          // delete all canvases (no more piling up of 50 canvases)
           // if run for a single subsystem this leaves the canvas intact
           // for debugging
-          TSeqCollection *allCanvases = gROOT->GetListOfCanvases();
-          TCanvas *canvas = nullptr;
-          while ((canvas = static_cast<TCanvas *>(allCanvases->First())))
-          {
-            std::cout << "Deleting Canvas " << canvas->GetName() << std::endl;
-            delete canvas;
-          }
+          DeleteCanvases();
         }
       }
       SetStyleToDefault();
@@ -584,6 +1006,19 @@ int OnlMonClient::DoSomething(const std::string &who, const std::string &what, c
   return 0;
 }
 
+void OnlMonClient::DeleteCanvases()
+{
+  // delete all canvases (no more piling up of 50 canvases)
+  TSeqCollection *allCanvases = gROOT->GetListOfCanvases();
+  TCanvas *canvas = nullptr;
+  while ((canvas = static_cast<TCanvas *>(allCanvases->First())))
+  {
+    std::cout << "Deleting Canvas " << canvas->GetName() << std::endl;
+    delete canvas;
+  }
+  return;
+}
+
 int OnlMonClient::requestHistoByName(const std::string &subsys, const std::string &what)
 {
   std::string hostname = "UNKNOWN";
@@ -626,93 +1061,421 @@ int OnlMonClient::requestHistoByName(const std::string &subsys, const std::strin
     histoiter = histos->second.find(what);
     if (histoiter != histos->second.end())
     {
-      hostname = histoiter->second->ServerHost();
-      moniport = histoiter->second->ServerPort();
-      if (hostname == "UNKNOWN")
-      {
-        std::cout << __PRETTY_FUNCTION__ << "host UNKNOWN for whatever reason" << std::endl;
-        return -3;
-      }
+      hostname = histoiter->second->ServerHost();
+      moniport = histoiter->second->ServerPort();
+      if (hostname == "UNKNOWN")
+      {
+        std::cout << __PRETTY_FUNCTION__ << "host UNKNOWN for whatever reason" << std::endl;
+        return -3;
+      }
+    }
+    else
+    {
+      std::cout << __PRETTY_FUNCTION__ << "Problem determining host" << std::endl;
+    }
+  }
+  // Open connection to server
+  TSocket sock(hostname.c_str(), moniport);
+  TMessage *mess;
+  std::string fullhistoname = subsys + std::string(" ") + what;
+  if (Verbosity() > 2)
+  {
+    std::cout << __PRETTY_FUNCTION__ << " sending " << fullhistoname << " to " << hostname << " port " << moniport << std::endl;
+  }
+  sock.Send(fullhistoname.c_str());
+  while (true)
+  {
+    if (verbosity > 1)
+    {
+      std::cout << __PRETTY_FUNCTION__ << "Waiting for Message from : " << hostname
+                << " on port " << moniport << std::endl;
+    }
+    sock.Recv(mess);
+    if (!mess)  // if server is not up mess is NULL
+    {
+      std::cout << __PRETTY_FUNCTION__ << "Server not running on " << hostname << std::endl;
+      sock.Close();
+      return 1;
+    }
+    if (mess->What() == kMESS_STRING)
+    {
+      char str[OnlMonDefs::MSGLEN];
+      mess->ReadString(str, OnlMonDefs::MSGLEN);
+      delete mess;
+      if (verbosity > 1)
+      {
+        std::cout << __PRETTY_FUNCTION__ << "Message: " << str << std::endl;
+      }
+      if (!strcmp(str, "Finished"))
+      {
+        break;
+      }
+      else if (!strcmp(str, "UnknownHisto"))
+      {
+        break;
+      }
+      else
+      {
+        std::cout << __PRETTY_FUNCTION__ << "Unknown Text Message: " << str << std::endl;
+        sock.Send("Ack");
+      }
+    }
+    else if (mess->What() == kMESS_OBJECT)
+    {
+      TH1 *histo = static_cast<TH1 *>(mess->ReadObjectAny(mess->GetClass()));
+      OnlMonSparse::Read(mess, histo);
+      delete mess;
+      TH1 *maphist = static_cast<TH1 *>(histo->Clone(histo->GetName()));
+      if (verbosity > 1)
+      {
+        std::cout << __PRETTY_FUNCTION__ << "histoname: " << histo->GetName() << " at "
+                  << histo << std::endl;
+      }
+
+      updateHistoMap(subsys, histo->GetName(), maphist);
+      delete histo;
+      sock.Send("Ack");
+    }
+  }
+  sock.Send("Finished");  // tell server we are finished
+  // Close the socket
+  sock.Close();
+  return 0;
+}
+
+int OnlMonClient::requestHisto(const std::string &what, const std::string &hostname, const int moniport)
+{
+  // Open connection to server
+  TSocket sock(hostname.c_str(), moniport);
+  TMessage *mess;
+  sock.Send(what.c_str());
+  while (true)
+  {
+    sock.Recv(mess);
+    if (!mess)  // if server is not up mess is NULL
+    {
+      std::cout << __PRETTY_FUNCTION__ << "Server not running on " << hostname << std::endl;
+      sock.Close();
+      return 1;
+    }
+    if (mess->What() == kMESS_STRING)
+    {
+      char str[OnlMonDefs::MSGLEN];
+      mess->ReadString(str, OnlMonDefs::MSGLEN);
+      delete mess;
+      if (verbosity > 1)
+      {
+        std::cout << __PRETTY_FUNCTION__ << "Message: " << str << std::endl;
+      }
+
+      if (!strcmp(str, "Finished"))
+      {
+        break;
+      }
+      else if (!strcmp(str, "UnknownHisto"))
+      {
+        break;
+      }
+      else
+      {
+        std::cout << __PRETTY_FUNCTION__ << "Unknown Text Message: " << str << std::endl;
+        sock.Send("Ack");
+      }
+    }
+    else if (mess->What() == kMESS_OBJECT)
+    {
+      // this reads the message and allocate space for new histogram
+      TH1 *histo = static_cast<TH1 *>(mess->ReadObjectAny(mess->GetClass()));
+      OnlMonSparse::Read(mess, histo);
+      delete mess;
+      if (verbosity > 1)
+      {
+        std::cout << __PRETTY_FUNCTION__ << "histoname: " << histo->GetName() << " at "
+                  << histo << std::endl;
+      }
+
+      updateHistoMap(what, histo->GetName(), histo);
+      sock.Send("Ack");
+    }
+  }
+  sock.Send("Finished");  // tell server we are finished
+
+  // Close the socket
+  sock.Close();
+  return 0;
+}
+
+unsigned int OnlMonClient::requestHistoVersion(const std::string &subsys, const std::string &hname)
+{
+  unsigned int version = 0;
+  auto moniter = MonitorHostPorts.find(subsys);
+  if (moniter == MonitorHostPorts.end())
+  {
+    return version;
+  }
+  TSocket sock(moniter->second.first.c_str(), moniter->second.second);
+  TMessage *mess;
+  std::string command = std::string("VERSION ") + subsys + ' ' + hname;
+  sock.Send(command.c_str());
+  sock.Recv(mess);
+  if (!mess)  // if server is not up mess is NULL
+  {
+    std::cout << __PRETTY_FUNCTION__ << "Server not running on " << moniter->second.first << std::endl;
+    sock.Close();
+    return version;
+  }
+  if (mess->What() == kMESS_STRING)
+  {
+    char str[OnlMonDefs::MSGLEN];
+    mess->ReadString(str, OnlMonDefs::MSGLEN);
+    if (verbosity > 1)
+    {
+      std::cout << __PRETTY_FUNCTION__ << "Message: " << str << std::endl;
+    }
+    // old servers reply UnknownHisto, strtoul gives 0 for it
+    version = strtoul(str, nullptr, 10);
+  }
+  delete mess;
+  sock.Send("Finished");
+  sock.Close();
+  return version;
+}
+
+int OnlMonClient::requestHistoVersions(const std::string &subsys, std::map<std::string, unsigned int> &versions)
+{
+  auto moniter = MonitorHostPorts.find(subsys);
+  if (moniter == MonitorHostPorts.end())
+  {
+    return -1;
+  }
+  int iret = fetchHistoVersions(moniter->second.first, moniter->second.second, subsys, versions, Verbosity());
+  // kept for requestHistoRebinned, saves it a round trip per histogram
+  if (iret == 0)
+  {
+    m_ServerVersions[subsys] = std::make_pair(time(nullptr), versions);
+  }
+  else
+  {
+    m_ServerVersions.erase(subsys);
+  }
+  return iret;
+}
+
+unsigned int OnlMonClient::ServerVersion(const std::string &subsys, const std::string &hname) const
+{
+  auto veriter = m_ServerVersions.find(subsys);
+  if (veriter == m_ServerVersions.end())
+  {
+    return 0;
+  }
+  auto hiter = veriter->second.second.find(hname);
+  return (hiter != veriter->second.second.end()) ? hiter->second : 0;
+}
+
+int OnlMonClient::fetchHistoVersions(const std::string &hostname, const int moniport, const std::string &subsys, std::map<std::string, unsigned int> &versions, const int verb)
+{
+  TSocket sock(hostname.c_str(), moniport);
+  TMessage *mess;
+  std::string command = std::string("VERSIONS ") + subsys;
+  sock.Send(command.c_str());
+  int iret = -1;
+  while (true)
+  {
+    sock.Recv(mess);
+    if (!mess)  // if server is not up mess is NULL
+    {
+      std::cout << __PRETTY_FUNCTION__ << "Server not running on " << hostname << std::endl;
+      sock.Close();
+      return -1;
+    }
+    if (mess->What() != kMESS_STRING)
+    {
+      std::cout << __PRETTY_FUNCTION__ << "received unexpected message type: " << mess->What() << std::endl;
+      delete mess;
+      break;
+    }
+    char strmess[OnlMonDefs::MSGLEN];
+    mess->ReadString(strmess, OnlMonDefs::MSGLEN);
+    delete mess;
+    std::string str(strmess);
+    if (verb > 2)
+    {
+      std::cout << __PRETTY_FUNCTION__ << "Message: " << str << std::endl;
+    }
+    if (str == "Finished")
+    {
+      iret = 0;
+      break;
+    }
+    // servers which do not know the VERSIONS command treat it as histogram request
+    if (str == "UnknownHisto")
+    {
+      break;
+    }
+    unsigned int pos_space = str.find(' ');
+    versions[str.substr(0, pos_space)] = strtoul(str.substr(pos_space + 1).c_str(), nullptr, 10);
+    sock.Send("Ack");
+  }
+  sock.Send("Finished");  // tell server we are finished
+  sock.Close();
+  return iret;
+}
+
+TH1 *OnlMonClient::requestHistoSlice(const std::string &subsys, const std::string &hname, const int xlo, const int xhi,
+                                     const int ylo, const int yhi, const int zlo, const int zhi)
+{
+  auto moniter = MonitorHostPorts.find(subsys);
+  if (moniter == MonitorHostPorts.end())
+  {
+    if (Verbosity() > 0)
+    {
+      std::cout << __PRETTY_FUNCTION__ << " no server known for " << subsys << std::endl;
+    }
+    return nullptr;
+  }
+  std::ostringstream command;
+  command << "SLICE " << subsys << ' ' << hname << ' ' << xlo << ' ' << xhi << ' '
+          << ylo << ' ' << yhi << ' ' << zlo << ' ' << zhi;
+  return fetchHistoObject(moniter->second.first, moniter->second.second, command.str(), Verbosity());
+}
+
+TH1 *OnlMonClient::requestHistoRebinned(const std::string &subsys, const std::string &hname, const int fx, const int fy, const int fz)
+{
+  std::vector<TH1 *> histos;
+  if (requestHistosRebinned(subsys, {hname}, fx, fy, fz, histos) < 0)
+  {
+    return nullptr;
+  }
+  return histos[0];
+}
+
+int OnlMonClient::requestHistosRebinned(const std::string &subsys, const std::vector<std::string> &hnames, const int fx, const int fy, const int fz, std::vector<TH1 *> &histos)
+{
+  histos.clear();
+  auto moniter = MonitorHostPorts.find(subsys);
+  if (moniter == MonitorHostPorts.end())
+  {
+    if (Verbosity() > 0)
+    {
+      std::cout << __PRETTY_FUNCTION__ << " no server known for " << subsys << std::endl;
+    }
+    return -1;
+  }
+  // one VERSIONS request covers all histograms of the monitor, usually the
+  // last update of the monitor already asked for it
+  auto veriter = m_ServerVersions.find(subsys);
+  if (veriter == m_ServerVersions.end() || time(nullptr) - veriter->second.first > m_ServerVersionsMaxAge)
+  {
+    std::map<std::string, unsigned int> versions;
+    requestHistoVersions(subsys, versions);
+  }
+  std::vector<std::string> keys;
+  std::list<std::string> commands;
+  std::vector<std::string> changed;
+  for (auto &hname : hnames)
+  {
+    std::ostringstream command;
+    command << subsys << ' ' << hname << ' ' << fx << ' ' << fy << ' ' << fz;
+    keys.push_back(command.str());
+    auto rebiniter = m_RebinnedHistos.find(command.str());
+    unsigned int version = ServerVersion(subsys, hname);
+    if (rebiniter == m_RebinnedHistos.end() || version == 0 || rebiniter->second.first != version)
+    {
+      commands.push_back(command.str());
+      changed.push_back(hname);
+    }
+  }
+  // the changed ones over one connection
+  std::vector<TH1 *> fetched;
+  if (!commands.empty())
+  {
+    fetchRebinnedList(moniter->second.first, moniter->second.second, commands, fetched, Verbosity());
+  }
+  auto command = commands.begin();
+  for (unsigned int i = 0; i < changed.size(); ++i, ++command)
+  {
+    // keep showing what we have if the server did not send it
+    if (i >= fetched.size() || !fetched[i])
+    {
+      continue;
     }
-    else
+    auto rebiniter = m_RebinnedHistos.find(*command);
+    if (rebiniter != m_RebinnedHistos.end())
     {
-      std::cout << __PRETTY_FUNCTION__ << "Problem determining host" << std::endl;
+      delete rebiniter->second.second;
     }
+    m_RebinnedHistos[*command] = std::make_pair(ServerVersion(subsys, changed[i]), fetched[i]);
   }
-  // Open connection to server
+  for (auto &key : keys)
+  {
+    auto rebiniter = m_RebinnedHistos.find(key);
+    histos.push_back((rebiniter != m_RebinnedHistos.end()) ? rebiniter->second.second : nullptr);
+  }
+  return changed.size();
+}
+
+int OnlMonClient::fetchRebinnedList(const std::string &hostname, const int moniport, const std::list<std::string> &commands, std::vector<TH1 *> &histos, const int verb)
+{
   TSocket sock(hostname.c_str(), moniport);
   TMessage *mess;
-  std::string fullhistoname = subsys + std::string(" ") + what;
-  if (Verbosity() > 2)
+  sock.Send("REBINLIST");
+  sock.Recv(mess);
+  if (!mess)  // if server is not up mess is NULL
   {
-    std::cout << __PRETTY_FUNCTION__ << " sending " << fullhistoname << " to " << hostname << " port " << moniport << std::endl;
+    std::cout << __PRETTY_FUNCTION__ << "Server not running on " << hostname << std::endl;
+    sock.Close();
+    return 1;
   }
-  sock.Send(fullhistoname.c_str());
-  while (true)
+  delete mess;
+  for (auto &command : commands)
   {
-    if (verbosity > 1)
+    if (verb > 2)
     {
-      std::cout << __PRETTY_FUNCTION__ << "Waiting for Message from : " << hostname
-                << " on port " << moniport << std::endl;
+      std::cout << __PRETTY_FUNCTION__ << "asking for " << command << std::endl;
     }
+    sock.Send(command.c_str());
     sock.Recv(mess);
-    if (!mess)  // if server is not up mess is NULL
+    if (!mess)
     {
-      std::cout << __PRETTY_FUNCTION__ << "Server not running on " << hostname << std::endl;
+      std::cout << __PRETTY_FUNCTION__ << "Server shut down during getting rebinned histos" << std::endl;
       sock.Close();
       return 1;
     }
-    if (mess->What() == kMESS_STRING)
+    TH1 *histo = nullptr;
+    if (mess->What() == kMESS_OBJECT)
     {
-      char str[OnlMonDefs::MSGLEN];
-      mess->ReadString(str, OnlMonDefs::MSGLEN);
-      delete mess;
-      if (verbosity > 1)
-      {
-        std::cout << __PRETTY_FUNCTION__ << "Message: " << str << std::endl;
-      }
-      if (!strcmp(str, "Finished"))
-      {
-        break;
-      }
-      else if (!strcmp(str, "UnknownHisto"))
-      {
-        break;
-      }
-      else
-      {
-        std::cout << __PRETTY_FUNCTION__ << "Unknown Text Message: " << str << std::endl;
-        sock.Send("Ack");
-      }
+      histo = static_cast<TH1 *>(mess->ReadObjectAny(mess->GetClass()));
+      OnlMonSparse::Read(mess, histo);
+      histo->SetDirectory(nullptr);
     }
-    else if (mess->What() == kMESS_OBJECT)
+    else if (verb > 1)
     {
-      TH1 *histo = static_cast<TH1 *>(mess->ReadObjectAny(mess->GetClass()));
-      delete mess;
-      TH1 *maphist = static_cast<TH1 *>(histo->Clone(histo->GetName()));
-      if (verbosity > 1)
-      {
-        std::cout << __PRETTY_FUNCTION__ << "histoname: " << histo->GetName() << " at "
-                  << histo << std::endl;
-      }
-
-      updateHistoMap(subsys, histo->GetName(), maphist);
-      delete histo;
-      sock.Send("Ack");
+      char str[OnlMonDefs::MSGLEN];
+      mess->ReadString(str, OnlMonDefs::MSGLEN);
+      std::cout << __PRETTY_FUNCTION__ << "Message: " << str << std::endl;
     }
+    delete mess;
+    // nullptr for UnknownHisto, the answers stay in the order of the commands
+    histos.push_back(histo);
   }
+  sock.Send("alldone");
+  sock.Recv(mess);
+  delete mess;
   sock.Send("Finished");  // tell server we are finished
-  // Close the socket
   sock.Close();
   return 0;
 }
 
-int OnlMonClient::requestHisto(const std::string &what, const std::string &hostname, const int moniport)
+TH1 *OnlMonClient::fetchHistoObject(const std::string &hostname, const int moniport, const std::string &command, const int verb)
 {
-  // Open connection to server
   TSocket sock(hostname.c_str(), moniport);
   TMessage *mess;
-  sock.Send(what.c_str());
+  if (verb > 2)
+  {
+    std::cout << __PRETTY_FUNCTION__ << " sending " << command << " to " << hostname << " port " << moniport << std::endl;
+  }
+  sock.Send(command.c_str());
+  TH1 *histo = nullptr;
   while (true)
   {
     sock.Recv(mess);
@@ -720,52 +1483,42 @@ int OnlMonClient::requestHisto(const std::string &what, const std::string &hostn
     {
       std::cout << __PRETTY_FUNCTION__ << "Server not running on " << hostname << std::endl;
       sock.Close();
-      return 1;
+      return histo;
     }
     if (mess->What() == kMESS_STRING)
     {
       char str[OnlMonDefs::MSGLEN];
       mess->ReadString(str, OnlMonDefs::MSGLEN);
       delete mess;
-      if (verbosity > 1)
+      if (verb > 1)
       {
         std::cout << __PRETTY_FUNCTION__ << "Message: " << str << std::endl;
       }
-
-      if (!strcmp(str, "Finished"))
-      {
-        break;
-      }
-      else if (!strcmp(str, "UnknownHisto"))
+      if (!strcmp(str, "Finished") || !strcmp(str, "UnknownHisto"))
       {
         break;
       }
-      else
-      {
-        std::cout << __PRETTY_FUNCTION__ << "Unknown Text Message: " << str << std::endl;
-        sock.Send("Ack");
-      }
+      std::cout << __PRETTY_FUNCTION__ << "Unknown Text Message: " << str << std::endl;
+      sock.Send("Ack");
     }
     else if (mess->What() == kMESS_OBJECT)
     {
-      // this reads the message and allocate space for new histogram
-      TH1 *histo = static_cast<TH1 *>(mess->ReadObjectAny(mess->GetClass()));
+      delete histo;
+      histo = static_cast<TH1 *>(mess->ReadObjectAny(mess->GetClass()));
+      OnlMonSparse::Read(mess, histo);
       delete mess;
-      if (verbosity > 1)
+      histo->SetDirectory(nullptr);
+      if (verb > 1)
       {
         std::cout << __PRETTY_FUNCTION__ << "histoname: " << histo->GetName() << " at "
                   << histo << std::endl;
       }
-
-      updateHistoMap(what, histo->GetName(), histo);
       sock.Send("Ack");
     }
   }
   sock.Send("Finished");  // tell server we are finished
-
-  // Close the socket
   sock.Close();
-  return 0;
+  return histo;
 }
 
 int OnlMonClient::requestMonitorList(const std::string &hostname, const int moniport)
@@ -819,6 +1572,17 @@ int OnlMonClient::requestMonitorList(const std::string &hostname, const int moni
 }
 
 int OnlMonClient::requestHistoList(const std::string &subsys, const std::string &hostname, const int moniport, std::list<std::string> &histolist)
+{
+  std::vector<TH1 *> histos;
+  int iret = fetchHistoList(hostname, moniport, histolist, histos, verbosity);
+  for (auto histo : histos)
+  {
+    updateHistoMap(subsys, histo->GetName(), histo);
+  }
+  return iret;
+}
+
+int OnlMonClient::fetchHistoList(const std::string &hostname, const int moniport, const std::list<std::string> &histolist, std::vector<TH1 *> &histos, const int verb)
 {
   // Open connection to server
   TSocket sock(hostname.c_str(), moniport);
@@ -836,7 +1600,7 @@ int OnlMonClient::requestHistoList(const std::string &subsys, const std::string
   delete mess;
   for (listiter = histolist.begin(); listiter != histolist.end(); ++listiter)
   {
-    if (Verbosity() > 2)
+    if (verb > 2)
     {
       std::cout << __PRETTY_FUNCTION__ << "asking for " << *listiter << std::endl;
     }
@@ -853,7 +1617,7 @@ int OnlMonClient::requestHistoList(const std::string &subsys, const std::string
       char str[OnlMonDefs::MSGLEN];
       mess->ReadString(str, OnlMonDefs::MSGLEN);
       delete mess;
-      if (verbosity > 1)
+      if (verb > 1)
       {
         std::cout << __PRETTY_FUNCTION__ << "Message: " << str << std::endl;
       }
@@ -875,14 +1639,15 @@ int OnlMonClient::requestHistoList(const std::string &subsys, const std::string
     {
       // this reads the message and allocate space for new histogram
       TH1 *histo = static_cast<TH1 *>(mess->ReadObjectAny(mess->GetClass()));
+      OnlMonSparse::Read(mess, histo);
       delete mess;
-      if (verbosity > 1)
+      if (verb > 1)
       {
         std::cout << __PRETTY_FUNCTION__ << "histoname: " << histo->GetName() << " at "
                   << histo << std::endl;
       }
 
-      updateHistoMap(subsys, histo->GetName(), histo);
+      histos.push_back(histo);
     }
   }
   sock.Send("alldone");
@@ -895,6 +1660,90 @@ int OnlMonClient::requestHistoList(const std::string &subsys, const std::string
   return 0;
 }
 
+std::set<std::string> OnlMonClient::RegisteredMonitors() const
+{
+  std::set<std::string> monitors;
+  for (auto &subsysiter : SubsysHisto)
+  {
+    monitors.insert(subsysiter.first);
+  }
+  return monitors;
+}
+
+int OnlMonClient::PrefetchHistos(const std::set<std::string> &monitors)
+{
+  // histograms are streamed in the prefetch thread while this one draws
+  if (!gGlobalMutex)
+  {
+    std::cout << __PRETTY_FUNCTION__ << " ROOT::EnableThreadSafety() was not called at startup, not prefetching" << std::endl;
+    return -1;
+  }
+  std::list<ClientHistoPrefetch::Request> requests;
+  for (auto &monitor : monitors)
+  {
+    auto moniiter = MonitorHostPorts.find(monitor);
+    auto subsysiter = SubsysHisto.find(monitor);
+    // only monitors we talked to already, locating them is left to requestHistoBySubSystem
+    if (moniiter == MonitorHostPorts.end() || subsysiter == SubsysHisto.end())
+    {
+      if (Verbosity() > 0)
+      {
+        std::cout << "no server known for " << monitor << ", not prefetching it" << std::endl;
+      }
+      continue;
+    }
+    ClientHistoPrefetch::Request request;
+    request.subsys = monitor;
+    request.hostname = moniiter->second.first;
+    request.port = moniiter->second.second;
+    for (auto &hiter : subsysiter->second)
+    {
+      request.versions[hiter.first] = (hiter.second->Histo()) ? hiter.second->Version() : 0;
+    }
+    requests.push_back(request);
+  }
+  if (!m_Prefetch)
+  {
+    m_Prefetch = new ClientHistoPrefetch();
+    m_Prefetch->Verbosity(Verbosity());
+  }
+  m_Prefetch->Schedule(requests);
+  return requests.size();
+}
+
+int OnlMonClient::TakePrefetched(const std::string &monitor)
+{
+  ClientHistoPrefetch::Result result;
+  if (m_Prefetch->Take(monitor, result, m_PrefetchMaxAge))
+  {
+    return -1;
+  }
+  for (auto &hiter : result.histos)
+  {
+    updateHistoMap(monitor, hiter.first, hiter.second);
+    SubsysHisto[monitor][hiter.first]->Version(result.versions[hiter.first]);
+  }
+  // reset the histograms which do not exist on the server anymore
+  auto subsysiter = SubsysHisto.find(monitor);
+  if (subsysiter != SubsysHisto.end())
+  {
+    for (auto &hname : result.requested)
+    {
+      auto hiter = subsysiter->second.find(hname);
+      if (hiter != subsysiter->second.end() && hiter->second->Histo() &&
+          result.histos.find(hname) == result.histos.end())
+      {
+        hiter->second->Histo()->Reset();
+      }
+    }
+  }
+  if (Verbosity() > 1)
+  {
+    std::cout << "took " << result.histos.size() << " prefetched histograms of " << monitor << std::endl;
+  }
+  return 0;
+}
+
 void OnlMonClient::updateHistoMap(const std::string &subsys, const std::string &hname, TH1 *h1d)
 {
   auto subsysiter = SubsysHisto.find(subsys);
@@ -917,6 +1766,7 @@ void OnlMonClient::updateHistoMap(const std::string &subsys, const std::string &
     }
     delete histoiter->second->Histo();  // delete old histogram
     histoiter->second->Histo(h1d);
+    histoiter->second->Version(0);  // set by the caller if it knows the server version
   }
   else
   {
@@ -945,8 +1795,73 @@ OnlMonClient::getDrawer(const std::string &name)
 
 TH1 *OnlMonClient::getHisto(const std::string &monitor, const std::string &hname)
 {
+  TH1 *histo = nullptr;
   auto subsysiter = SubsysHisto.find(monitor);
-  if (subsysiter == SubsysHisto.end())
+  if (subsysiter != SubsysHisto.end())
+  {
+    auto hiter = subsysiter->second.find(hname);
+    if (hiter != subsysiter->second.end())
+    {
+      histo = hiter->second->Histo();
+    }
+  }
+  if (!histo && !m_LazyFiles.empty())
+  {
+    histo = LoadLazyHisto(monitor, hname);
+  }
+  if (!histo)
+  {
+    histo = getMergedHisto(monitor, hname);
+  }
+  return histo;
+}
+
+TH1 *OnlMonClient::LoadLazyHisto(const std::string &monitor, const std::string &hname)
+{
+  auto fileiter = m_LazyFiles.find(monitor);
+  if (fileiter == m_LazyFiles.end())
+  {
+    return nullptr;
+  }
+  auto keyiter = fileiter->second.second.find(hname);
+  if (keyiter == fileiter->second.second.end())
+  {
+    return nullptr;
+  }
+  TDirectory *save = gDirectory;
+  TH1 *histo = static_cast<TH1 *>(keyiter->second->ReadObj());
+  save->cd();
+  fileiter->second.second.erase(keyiter);
+  if (!histo)
+  {
+    return nullptr;
+  }
+  // detach from the file, it is deleted when the file is closed otherwise
+  histo->SetDirectory(nullptr);
+  if (verbosity > 0)
+  {
+    std::cout << "read " << hname << " of " << monitor << " from "
+              << fileiter->second.first->GetName() << std::endl;
+  }
+  updateHistoMap(monitor, hname, histo);
+  return histo;
+}
+
+void OnlMonClient::CloseLazyFile(const std::string &monitor)
+{
+  auto fileiter = m_LazyFiles.find(monitor);
+  if (fileiter != m_LazyFiles.end())
+  {
+    delete fileiter->second.first;
+    m_LazyFiles.erase(fileiter);
+  }
+  return;
+}
+
+TH1 *OnlMonClient::getMergedHisto(const std::string &monitor, const std::string &hname)
+{
+  auto subsysiter = SubsysMergedHisto.find(monitor);
+  if (subsysiter == SubsysMergedHisto.end())
   {
     return nullptr;
   }
@@ -955,7 +1870,26 @@ TH1 *OnlMonClient::getHisto(const std::string &monitor, const std::string &hname
   {
     return nullptr;
   }
-  return hiter->second->Histo();
+  std::vector<const ClientHistoList *> srclist;
+  for (auto &src : hiter->second->Sources())
+  {
+    if (!m_LazyFiles.empty())
+    {
+      LoadLazyHisto(src.first, src.second);
+    }
+    const ClientHistoList *srcentry = nullptr;
+    auto srcsubsys = SubsysHisto.find(src.first);
+    if (srcsubsys != SubsysHisto.end())
+    {
+      auto srchisto = srcsubsys->second.find(src.second);
+      if (srchisto != srcsubsys->second.end())
+      {
+        srcentry = srchisto->second;
+      }
+    }
+    srclist.push_back(srcentry);
+  }
+  return hiter->second->Update(srclist);
 }
 
 void OnlMonClient::Print(const char *what)
@@ -1033,6 +1967,21 @@ void OnlMonClient::Print(const char *what)
     }
     std::cout << std::endl;
   }
+  if (!strcmp(what, "ALL") || !strcmp(what, "MERGED"))
+  {
+    std::cout << "--------------------------------------" << std::endl
+              << std::endl;
+    std::cout << "List of Merged Histograms in OnlMonClient:" << std::endl;
+    for (auto &subs : SubsysMergedHisto)
+    {
+      for (auto &histos : subs.second)
+      {
+        std::cout << "Subsystem " << subs.first << ": ";
+        histos.second->identify();
+      }
+    }
+    std::cout << std::endl;
+  }
   if (!strcmp(what, "ALL") || !strcmp(what, "UNKNOWN"))
   {
     // loop over the map and print out the content (name and location in memory)
@@ -1259,28 +2208,78 @@ int OnlMonClient::ReadHistogramsFromFile(const std::string &filename)
   std::string subsys = ExtractSubsystem(filename);
   TDirectory *save = gDirectory;  // save current dir (which will be overwritten by the following fileopen)
   TFile *histofile = new TFile(filename.c_str(), "READ");
-  if (!histofile)
+  if (!histofile || histofile->IsZombie())
   {
     std::cout << "Can't open " << filename << std::endl;
+    delete histofile;
+    save->cd();
     return -1;
   }
   save->cd();
-  TIterator *titer = histofile->GetListOfKeys()->MakeIterator();
-  TObject *obj;
-  TH1 *histo, *histoptr;
-  while ((obj = titer->Next()))
+  // a new file for this subsystem replaces the previous one
+  CloseLazyFile(subsys);
+  auto subsysiter = SubsysHisto.find(subsys);
+  if (m_LazyHistoRead && subsysiter != SubsysHisto.end())
+  {
+    // drop everything of the previous file, also histograms the new one does
+    // not have. getHisto reads the new ones
+    for (auto &hiter : subsysiter->second)
+    {
+      if (hiter.second->Histo())
+      {
+        delete hiter.second->Histo();
+        hiter.second->Histo(nullptr);
+      }
+    }
+  }
+  std::map<std::string, TKey *> lazykeys;
+  std::set<std::string> seen;
+  TIter next(histofile->GetListOfKeys());
+  TKey *key;
+  while ((key = static_cast<TKey *>(next())))
   {
     if (verbosity > 0)
     {
-      std::cout << "TObject at " << obj << std::endl;
-      std::cout << obj->GetName() << std::endl;
-      std::cout << obj->ClassName() << std::endl;
+      std::cout << "TKey at " << key << std::endl;
+      std::cout << key->GetName() << std::endl;
+      std::cout << key->GetClassName() << std::endl;
+    }
+    std::string hname = key->GetName();
+    // keys of older cycles come after the latest one
+    if (!seen.insert(hname).second)
+    {
+      continue;
+    }
+    TClass *keyclass = TClass::GetClass(key->GetClassName());
+    if (!keyclass || !keyclass->InheritsFrom(TH1::Class()))
+    {
+      continue;
+    }
+    ClientHistoList *entry = nullptr;
+    if (subsysiter != SubsysHisto.end())
+    {
+      auto hiter = subsysiter->second.find(hname);
+      if (hiter != subsysiter->second.end())
+      {
+        entry = hiter->second;
+      }
+    }
+    if (m_ReadRegisteredOnly && !entry)
+    {
+      continue;
+    }
+    if (m_LazyHistoRead)
+    {
+      lazykeys.insert(std::make_pair(hname, key));
+      continue;
     }
-    histofile->GetObject(obj->GetName(), histoptr);
-    if (histoptr)
+    TH1 *histo = static_cast<TH1 *>(key->ReadObj());
+    save->cd();
+    if (histo)
     {
-      histo = static_cast<TH1 *>(histoptr->Clone());
-      updateHistoMap(subsys, histo->GetName(), histo);
+      // detach instead of cloning, saves a copy of every histogram
+      histo->SetDirectory(nullptr);
+      updateHistoMap(subsys, hname, histo);
       if (verbosity > 0)
       {
         std::cout << "HistoName: " << histo->GetName() << std::endl;
@@ -1288,11 +2287,50 @@ int OnlMonClient::ReadHistogramsFromFile(const std::string &filename)
       }
     }
   }
+  if (!lazykeys.empty())
+  {
+    m_LazyFiles[subsys] = std::make_pair(histofile, lazykeys);
+    return 0;
+  }
   delete histofile;
-  delete titer;
   return 0;
 }
 
+std::string OnlMonClient::HistoFileFromIndex(const int runno, const std::string &monitor, const std::string &indexfile)
+{
+  std::string idxfile = (indexfile.empty()) ? OnlMonFileIndex::DefaultIndexFile() : indexfile;
+  if (!m_FileIndex || m_FileIndex->IndexFile() != idxfile)
+  {
+    delete m_FileIndex;
+    m_FileIndex = new OnlMonFileIndex(idxfile);
+    m_FileIndex->Verbosity(Verbosity());
+    m_FileIndex->Read();
+  }
+  const OnlMonFileIndex::FileEntry *entry = m_FileIndex->Find(runno, monitor);
+  if (!entry)
+  {
+    // the index might have been updated since we read it
+    m_FileIndex->Read();
+    entry = m_FileIndex->Find(runno, monitor);
+  }
+  if (!entry)
+  {
+    return "";
+  }
+  return entry->filename;
+}
+
+int OnlMonClient::ReadHistogramsFromIndex(const int runno, const std::string &monitor, const std::string &indexfile)
+{
+  std::string filename = HistoFileFromIndex(runno, monitor, indexfile);
+  if (filename.empty())
+  {
+    std::cout << "no histogram file for run " << runno << " of " << monitor << " in index" << std::endl;
+    return -1;
+  }
+  return ReadHistogramsFromFile(filename);
+}
+
 int OnlMonClient::SendCommand(const char *hostname, const int port, const char *cmd)
 {
   // Open connection to server
@@ -1378,11 +2416,6 @@ OnlMonClient::htmlRegisterPage(const OnlMonDraw &drawer,
 
 int OnlMonClient::CanvasToPng(TCanvas *canvas, std::string const &pngfilename)
 {
-  // in order not to collide when running multiple html generators
-  // create a unique filename (okay tempnam is not totally safe against
-  // multiple procs getting the same name but the local /tmp filesystem should
-  // prevent at least multiple machines colliding)
-  // returned char array needs to be free'd after use
   if (!canvas)
   {
     std::cout << __PRETTY_FUNCTION__ << " TCanvas is Null Pointer" << std::endl;
@@ -1394,20 +2427,7 @@ int OnlMonClient::CanvasToPng(TCanvas *canvas, std::string const &pngfilename)
               << canvas->GetName() << std::endl;
     return -1;
   }
-  uuid_t uu;
-  uuid_generate(uu);
-  char uuid[50];
-  uuid_unparse(uu, uuid);
-  std::string tmpname = "/tmp/TC" + std::string(uuid);
-  canvas->Print(tmpname.c_str(), "gif");  // write gif format
-  TImage *img = TImage::Open(tmpname.c_str());
-  img->WriteImage(pngfilename.c_str());
-  delete img;
-  if (remove(tmpname.c_str()))
-  {
-    std::cout << "Error removing " << tmpname << std::endl;
-  }
-  return 0;
+  return PadToPng(canvas, pngfilename);
 }
 
 int OnlMonClient::HistoToPng(TH1 *histo, std::string const &pngfilename, const char *drawopt, const int statopt)
@@ -1425,19 +2445,30 @@ int OnlMonClient::HistoToPng(TH1 *histo, std::string const &pngfilename, const c
   histo->SetMarkerStyle(8);
   histo->SetMarkerSize(0.15);
   histo->Draw(drawopt);
-  uuid_t uu;
-  uuid_generate(uu);
-  char uuid[50];
-  uuid_unparse(uu, uuid);
-  std::string tmpname = "/tmp/TC" + std::string(uuid);
-  cgiCanv->Print(tmpname.c_str(), "gif");
-  TImage *img = TImage::Open(tmpname.c_str());
-  img->WriteImage(pngfilename.c_str());
-  if (remove(tmpname.c_str()))
-  {
-    std::cout << "Error removing " << tmpname << std::endl;
-  }
+  int iret = PadToPng(cgiCanv, pngfilename);
   delete cgiCanv;
+  return iret;
+}
+
+int OnlMonClient::PadToPng(TPad *pad, std::string const &pngfilename)
+{
+  // rasterize the pad directly into the image buffer and encode the png
+  // once, no temporary gif in /tmp anymore
+  pad->Modified();
+  pad->Update();
+  TImage *img = TImage::Create();
+  if (!img)
+  {
+    std::cout << __PRETTY_FUNCTION__ << " cannot create TImage for " << pngfilename << std::endl;
+    return -3;
+  }
+  img->FromPad(pad);
+  if (m_PngCompression >= 0)
+  {
+    img->SetImageCompression(m_PngCompression);
+  }
+  img->WriteImage(pngfilename.c_str(), TImage::kPng);
+  delete img;
   return 0;
 }
 
@@ -12,10 +12,16 @@
 #include <vector>
 
 class ClientHistoList;
+class ClientHistoPrefetch;
+class ClientMergedHisto;
 class OnlMonDraw;
+class OnlMonFileIndex;
 class OnlMonHtml;
 class TCanvas;
+class TFile;
 class TH1;
+class TKey;
+class TPad;
 class TStyle;
 
 class OnlMonClient : public OnlMonBase
@@ -36,16 +42,83 @@ class OnlMonClient : public OnlMonBase
   int requestHistoList(const std::string &subsys, const std::string &hostname, const int moniport, std::list<std::string> &histolist);
   int requestHistoByName(const std::string &subsystem, const std::string &what = "ALL");
   int requestHistoBySubSystem(const std::string &subsystem, int getall = 0);
+  unsigned int requestHistoVersion(const std::string &subsystem, const std::string &hname);
+  int requestHistoVersions(const std::string &subsystem, std::map<std::string, unsigned int> &versions);
+  // the server protocol of requestHistoList/requestHistoVersions, these do not touch the client
+  // and can be used from other threads
+  static int fetchHistoList(const std::string &hostname, const int moniport, const std::list<std::string> &histolist, std::vector<TH1 *> &histos, const int verb = 0);
+  static int fetchHistoVersions(const std::string &hostname, const int moniport, const std::string &subsystem, std::map<std::string, unsigned int> &versions, const int verb = 0);
+  // bins xlo..xhi, ylo..yhi, zlo..zhi of hname cut out by the server (hi < lo: full axis),
+  // only the slice is transferred. The caller owns the returned histogram, nullptr on failure
+  TH1 *requestHistoSlice(const std::string &subsystem, const std::string &hname, const int xlo, const int xhi,
+                         const int ylo = 1, const int yhi = 0, const int zlo = 1, const int zhi = 0);
+  // hname with fx x fy x fz bins combined by the server, for overview displays which
+  // have fewer pixels than the histogram has bins (getHisto() is the full resolution).
+  // Copies are cached per resolution and only fetched again if the server version
+  // changed. The version comes from the last VERSIONS answer of the monitor (see
+  // ServerVersion), it is asked for again if that is older than ServerVersionsMaxAge.
+  // The client owns the returned histogram, nullptr if no server is known for the monitor
+  TH1 *requestHistoRebinned(const std::string &subsystem, const std::string &hname, const int fx, const int fy = 1, const int fz = 1);
+  // requestHistoRebinned for several histograms of a monitor, the changed ones are fetched
+  // over one connection (REBINLIST) instead of one per histogram. histos gets the cached
+  // copies in the order of hnames (nullptr if there is none), returns the number of
+  // histograms which were asked for, -1 if no server is known for the monitor
+  int requestHistosRebinned(const std::string &subsystem, const std::vector<std::string> &hnames, const int fx, const int fy, const int fz, std::vector<TH1 *> &histos);
+  // version of hname in the last VERSIONS answer of its server, 0 if not known.
+  // Every requestHistoBySubSystem(subsystem, 1) refreshes them
+  unsigned int ServerVersion(const std::string &subsystem, const std::string &hname) const;
+  // versions older than this (seconds) are asked for again by requestHistoRebinned
+  void ServerVersionsMaxAge(const int i) { m_ServerVersionsMaxAge = i; }
+  // send a command which is answered with a single histogram (or UnknownHisto)
+  static TH1 *fetchHistoObject(const std::string &hostname, const int moniport, const std::string &command, const int verb = 0);
+  // send REBIN arguments over one REBINLIST connection, histos gets one entry per command
+  static int fetchRebinnedList(const std::string &hostname, const int moniport, const std::list<std::string> &commands, std::vector<TH1 *> &histos, const int verb = 0);
+  // fetch the histograms of these monitors in a background thread, the next
+  // requestHistoBySubSystem(monitor, 1) takes them instead of asking the server.
+  // Needs ROOT::EnableThreadSafety() at program startup, returns -1 without it
+  int PrefetchHistos(const std::set<std::string> &monitors);
+  // prefetched histograms older than this (seconds) are not used
+  void PrefetchMaxAge(const int i) { m_PrefetchMaxAge = i; }
+  std::set<std::string> RegisteredMonitors() const;
   void registerHisto(const std::string &hname, const std::string &subsys);
+  // histogram hname of monitor subsys is merged from the same histogram of the source monitors
+  // operations are SUM, MAX and AVERAGE. Access it via getHisto(subsys, hname)
+  int registerMergedHisto(const std::string &subsys, const std::string &hname, const std::vector<std::string> &sourcesubsys, const std::string &operation = "SUM");
+  // add a source with a different histogram name (e.g. MVTXMON_chipHitmapFLX0 from MVTXMON_0)
+  int addMergeSource(const std::string &subsys, const std::string &hname, const std::string &sourcesubsys, const std::string &sourcehname);
   void Print(const char *what = "ALL");
 
   void AddServerHost(const std::string &hostname);
   void registerDrawer(OnlMonDraw *Drawer);
   int ReadHistogramsFromFile(const std::string &filename);
+  // only index the file in ReadHistogramsFromFile, histograms are read on first getHisto
+  void LazyHistoRead(const int i) { m_LazyHistoRead = i; }
+  int LazyHistoRead() const { return m_LazyHistoRead; }
+  // ReadHistogramsFromFile only takes histograms registered with registerHisto
+  void ReadRegisteredHistosOnly(const int i) { m_ReadRegisteredOnly = i; }
+  int ReadRegisteredHistosOnly() const { return m_ReadRegisteredOnly; }
+  // finds the file of run/monitor in the histogram file index (default $ONLMON_SAVEDIR/onlmon_histo.index)
+  int ReadHistogramsFromIndex(const int runno, const std::string &monitor, const std::string &indexfile = "");
+  std::string HistoFileFromIndex(const int runno, const std::string &monitor, const std::string &indexfile = "");
   int Draw(const char *who = "ALL", const char *what = "ALL");
   int MakePS(const char *who = "ALL", const char *what = "ALL");
   int MakeHtml(const char *who = "ALL", const char *what = "ALL");
   int SavePlot(const std::string &who = "ALL", const std::string &what = "ALL");
+  // MakeHtml("ALL") forks this many batch mode workers which share the drawers,
+  // it runs serially while canvases, the histogram prefetch, a db connection or
+  // lazily read histogram files exist
+  void HtmlWorkers(const unsigned int i) { m_HtmlWorkers = i; }
+  unsigned int HtmlWorkers() const { return m_HtmlWorkers; }
+  // skip MakeHtml of drawers which implement OnlMonDraw::HistoVersions if none
+  // of their histograms changed since the last html output of this run
+  void HtmlIncremental(const int i) { m_HtmlIncremental = i; }
+  int HtmlIncremental() const { return m_HtmlIncremental; }
+  // skip Draw of drawers which implement OnlMonDraw::HistoVersions if their
+  // histograms did not change and their canvases are still there
+  void DrawIncremental(const int i) { m_DrawIncremental = i; }
+  int DrawIncremental() const { return m_DrawIncremental; }
+  // counts how often a histogram was replaced (merged: sum of its sources)
+  unsigned int HistoUpdates(const std::string &monitor, const std::string &hname);
 
   std::string htmlRegisterPage(const OnlMonDraw &drawer,
                                const std::string &path,
@@ -71,6 +144,9 @@ class OnlMonClient : public OnlMonBase
   int GetDisplaySizeY() { return display_sizey; }
   int CanvasToPng(TCanvas *canvas, std::string const &filename);
   int HistoToPng(TH1 *histo, std::string const &pngfilename, const char *drawopt = "", const int statopt = 11);
+  // png compression 0 (none, fast) - 100 (best), negative: libAfterImage default
+  void PngCompression(const int i) { m_PngCompression = i; }
+  int PngCompression() const { return m_PngCompression; }
 
   int SaveLogFile(const OnlMonDraw &drawer);
   int SetStyleToDefault();
@@ -87,9 +163,24 @@ class OnlMonClient : public OnlMonBase
   OnlMonClient(const std::string &name = "ONLMONCLIENT");
   int DoSomething(const std::string &who, const std::string &what, const std::string &opt);
   void InitAll();
+  int PadToPng(TPad *pad, std::string const &pngfilename);
+  int MakeHtmlParallel(const std::string &what);
+  int DrawerMakeHtml(OnlMonDraw *drawer, const std::string &what);
+  // 1 if the html output of the drawer is up to date, 0 if not and the versions
+  // are to be recorded with HtmlDone, -1 if it is always made
+  int HtmlUpToDate(OnlMonDraw *drawer, const std::string &what, std::map<std::string, unsigned int> &versions);
+  void HtmlDone(OnlMonDraw *drawer, const std::string &what, const std::map<std::string, unsigned int> &versions, const int status);
+  void DeleteCanvases();
+  int DrawerDraw(OnlMonDraw *drawer, const std::string &what);
+  TH1 *getMergedHisto(const std::string &monitor, const std::string &hname);
+  TH1 *LoadLazyHisto(const std::string &monitor, const std::string &hname);
+  void CloseLazyFile(const std::string &monitor);
+  int TakePrefetched(const std::string &monitor);
 
   static OnlMonClient *__instance;
   OnlMonHtml *fHtml = nullptr;
+  OnlMonFileIndex *m_FileIndex = nullptr;
+  ClientHistoPrefetch *m_Prefetch = nullptr;
   TH1 *clientrunning = nullptr;
   TStyle *defaultStyle = nullptr;
 
@@ -98,13 +189,32 @@ class OnlMonClient : public OnlMonBase
   int cosmicrun = 0;
   int standalone = 0;
   int cachedrun = 0;
+  int m_PngCompression = -1;
+  unsigned int m_HtmlWorkers = 1;
+  int m_HtmlIncremental = 0;
+  int m_DrawIncremental = 0;
+  int m_LazyHistoRead = 0;
+  int m_ReadRegisteredOnly = 0;
+  int m_PrefetchMaxAge = 60;
+  int m_ServerVersionsMaxAge = 10;
 
   std::string runtype = "UNKNOWN";
   std::set<std::string> m_MonitorFetchedSet;
   std::map<std::string, std::map<const std::string, ClientHistoList *>> SubsysHisto;
+  std::map<std::string, std::map<const std::string, ClientMergedHisto *>> SubsysMergedHisto;
+  // monitor -> open histogram file and its not yet read histogram keys
+  std::map<std::string, std::pair<TFile *, std::map<std::string, TKey *>>> m_LazyFiles;
   std::map<std::string, std::pair<std::string, unsigned int>> MonitorHostPorts;
   std::map<const std::string, ClientHistoList *> Histo;
   std::map<const std::string, OnlMonDraw *> DrawerList;
+  // drawer/what -> run number and histogram versions of the last MakeHtml
+  std::map<std::string, std::pair<int, std::map<std::string, unsigned int>>> m_HtmlDependencies;
+  // drawer/what -> histogram versions and canvases of the last Draw
+  std::map<std::string, std::pair<std::map<std::string, unsigned int>, std::set<std::string>>> m_DrawDependencies;
+  // monitor -> time and content of the last VERSIONS answer of its server
+  std::map<std::string, std::pair<time_t, std::map<std::string, unsigned int>>> m_ServerVersions;
+  // "subsys hname fx fy fz" -> server version and rebinned histogram
+  std::map<std::string, std::pair<unsigned int, TH1 *>> m_RebinnedHistos;
   std::vector<std::string> MonitorHosts;
 };
 
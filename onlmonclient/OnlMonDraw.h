@@ -1,6 +1,7 @@
 #ifndef ONLMONCLIENT_ONLMONDRAW_H
 #define ONLMONCLIENT_ONLMONDRAW_H
 
+#include <map>
 #include <string>
 
 class TPad;
@@ -16,6 +17,10 @@ class OnlMonDraw
   virtual int SavePlot(const std::string &what = "ALL", const std::string &type = "png");
   virtual int MakePS(const std::string &what = "ALL");
   virtual int MakeHtml(const std::string &what = "ALL");
+  // optional: fill versions (OnlMonClient::HistoUpdates()) of everything the canvases
+  // of what show and return 0, the client then skips Draw and MakeHtml while they
+  // do not change. Drawers without it (or showing db trends, the time, ...) are always redone
+  virtual int HistoVersions(const std::string & /*what*/, std::map<std::string, unsigned int> & /*versions*/) { return -1; }
   const std::string Name() const { return ThisName; }
   void Verbosity(const int i) { verbosity = i; }
   int Verbosity() const { return verbosity; }
@@ -0,0 +1,324 @@
+#include "OnlMonFileIndex.h"
+
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TKey.h>
+#include <TList.h>
+
+#include <sys/stat.h>
+#include <cstdio>   // for rename
+#include <cstdlib>  // for getenv
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+OnlMonFileIndex::OnlMonFileIndex(const std::string &indexfile)
+  : m_IndexFile(indexfile)
+{
+  if (m_IndexFile.empty())
+  {
+    m_IndexFile = DefaultIndexFile();
+  }
+}
+
+std::string OnlMonFileIndex::DefaultIndexFile()
+{
+  std::string dirname = "./";
+  if (getenv("ONLMON_SAVEDIR"))
+  {
+    dirname = std::string(getenv("ONLMON_SAVEDIR")) + "/";
+  }
+  return dirname + "onlmon_histo.index";
+}
+
+int OnlMonFileIndex::ParseFileName(const std::string &filename, int &runno, std::string &monitor)
+{
+  std::string fname = std::filesystem::path(filename).filename();
+  if (fname.find("Run_") != 0 || fname.size() <= 5 || fname.substr(fname.size() - 5) != ".root")
+  {
+    return -1;
+  }
+  size_t dash = fname.find('-');
+  if (dash == std::string::npos || dash == 4)
+  {
+    return -1;
+  }
+  std::string runstring = fname.substr(4, dash - 4);
+  // more than 9 digits do not fit into an int
+  if (runstring.size() > 9 || runstring.find_first_not_of("0123456789") != std::string::npos)
+  {
+    return -1;
+  }
+  runno = std::stoi(runstring);
+  monitor = fname.substr(dash + 1, fname.size() - 5 - dash - 1);
+  return 0;
+}
+
+int OnlMonFileIndex::Read()
+{
+  std::ifstream fin(m_IndexFile);
+  if (!fin.is_open())
+  {
+    if (m_Verbosity > 0)
+    {
+      std::cout << __PRETTY_FUNCTION__ << " no index file " << m_IndexFile << std::endl;
+    }
+    return -1;
+  }
+  m_Files.clear();
+  FileEntry *current = nullptr;
+  std::string line;
+  while (std::getline(fin, line))
+  {
+    if (line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+    std::istringstream iss(line);
+    if (line[0] == ' ')
+    {
+      if (!current)
+      {
+        continue;
+      }
+      KeyEntry key;
+      if (iss >> key.name >> key.classname >> key.cycle >> key.objlen >> key.nbytes)
+      {
+        current->keys.push_back(key);
+      }
+      continue;
+    }
+    FileEntry entry;
+    unsigned int nkeys;
+    if (!(iss >> entry.run >> entry.monitor >> entry.size >> entry.mtime >> nkeys))
+    {
+      std::cout << __PRETTY_FUNCTION__ << " bad line in " << m_IndexFile << ": " << line << std::endl;
+      current = nullptr;
+      continue;
+    }
+    std::getline(iss, entry.filename);
+    entry.filename.erase(0, entry.filename.find_first_not_of(' '));
+    entry.keys.reserve(nkeys);
+    current = &m_Files[entry.filename];
+    *current = entry;
+  }
+  fin.close();
+  BuildRunMap();
+  return 0;
+}
+
+int OnlMonFileIndex::Write() const
+{
+  // write a new file and move it in place, readers never see a partial index
+  std::string tmpfile = m_IndexFile + ".tmp";
+  std::ofstream fout(tmpfile);
+  if (!fout.is_open())
+  {
+    std::cout << __PRETTY_FUNCTION__ << " cannot open " << tmpfile << std::endl;
+    return -1;
+  }
+  fout << "# OnlMonFileIndex 1" << std::endl;
+  for (auto &fileiter : m_Files)
+  {
+    const FileEntry &entry = fileiter.second;
+    fout << entry.run << " " << entry.monitor << " " << entry.size << " "
+         << entry.mtime << " " << entry.keys.size() << " " << entry.filename << "\n";
+    for (auto &key : entry.keys)
+    {
+      fout << " " << key.name << " " << key.classname << " " << key.cycle << " "
+           << key.objlen << " " << key.nbytes << "\n";
+    }
+  }
+  fout.close();
+  if (!fout || std::rename(tmpfile.c_str(), m_IndexFile.c_str()))
+  {
+    std::cout << __PRETTY_FUNCTION__ << " could not write " << m_IndexFile << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+int OnlMonFileIndex::Scan(const std::string &topdir)
+{
+  std::error_code ec;
+  std::set<std::string> found;
+  int nopened = 0;
+  for (auto dirit = std::filesystem::recursive_directory_iterator(topdir, ec);
+       !ec && dirit != std::filesystem::recursive_directory_iterator(); dirit.increment(ec))
+  {
+    std::error_code fec;
+    if (!dirit->is_regular_file(fec))
+    {
+      continue;
+    }
+    std::string filename = dirit->path().string();
+    FileEntry entry;
+    if (ParseFileName(filename, entry.run, entry.monitor))
+    {
+      continue;
+    }
+    struct stat statbuf;
+    if (stat(filename.c_str(), &statbuf))
+    {
+      continue;
+    }
+    found.insert(filename);
+    auto fileiter = m_Files.find(filename);
+    if (fileiter != m_Files.end() &&
+        fileiter->second.size == statbuf.st_size &&
+        fileiter->second.mtime == statbuf.st_mtime)
+    {
+      continue;
+    }
+    entry.filename = filename;
+    entry.size = statbuf.st_size;
+    entry.mtime = statbuf.st_mtime;
+    nopened++;
+    if (IndexKeys(entry))
+    {
+      // unreadable (maybe still being written), try again next scan
+      if (fileiter != m_Files.end())
+      {
+        m_Files.erase(fileiter);
+      }
+      continue;
+    }
+    m_Files[filename] = entry;
+  }
+  if (ec)
+  {
+    // we did not see all files, removing the ones not found would empty the index
+    std::cout << __PRETTY_FUNCTION__ << " error scanning " << topdir << ": " << ec.message()
+              << ", not removing missing files from the index" << std::endl;
+    BuildRunMap();
+    return -1;
+  }
+  for (auto fileiter = m_Files.begin(); fileiter != m_Files.end();)
+  {
+    if (found.find(fileiter->first) == found.end())
+    {
+      fileiter = m_Files.erase(fileiter);
+    }
+    else
+    {
+      ++fileiter;
+    }
+  }
+  BuildRunMap();
+  if (m_Verbosity > 0)
+  {
+    std::cout << "indexed " << m_Files.size() << " files in " << topdir
+              << ", opened " << nopened << std::endl;
+  }
+  return nopened;
+}
+
+int OnlMonFileIndex::IndexKeys(FileEntry &entry) const
+{
+  TDirectory *save = gDirectory;
+  TFile *histofile = TFile::Open(entry.filename.c_str(), "READ");
+  save->cd();
+  if (!histofile || histofile->IsZombie())
+  {
+    std::cout << __PRETTY_FUNCTION__ << " cannot open " << entry.filename << std::endl;
+    delete histofile;
+    return -1;
+  }
+  // only the key headers are read, not the objects
+  TIter next(histofile->GetListOfKeys());
+  TKey *key;
+  while ((key = static_cast<TKey *>(next())))
+  {
+    KeyEntry keyentry;
+    keyentry.name = key->GetName();
+    keyentry.classname = key->GetClassName();
+    keyentry.cycle = key->GetCycle();
+    keyentry.objlen = key->GetObjlen();
+    keyentry.nbytes = key->GetNbytes();
+    entry.keys.push_back(keyentry);
+  }
+  delete histofile;
+  return 0;
+}
+
+void OnlMonFileIndex::BuildRunMap()
+{
+  m_RunMonitorFile.clear();
+  for (auto &fileiter : m_Files)
+  {
+    auto key = std::make_pair(fileiter.second.run, fileiter.second.monitor);
+    auto runiter = m_RunMonitorFile.find(key);
+    if (runiter == m_RunMonitorFile.end() ||
+        m_Files[runiter->second].mtime < fileiter.second.mtime)
+    {
+      m_RunMonitorFile[key] = fileiter.first;
+    }
+  }
+  return;
+}
+
+const OnlMonFileIndex::FileEntry *OnlMonFileIndex::Find(const int runno, const std::string &monitor) const
+{
+  auto runiter = m_RunMonitorFile.find(std::make_pair(runno, monitor));
+  if (runiter == m_RunMonitorFile.end())
+  {
+    return nullptr;
+  }
+  return &m_Files.find(runiter->second)->second;
+}
+
+const OnlMonFileIndex::KeyEntry *OnlMonFileIndex::FindKey(const int runno, const std::string &monitor, const std::string &hname) const
+{
+  const FileEntry *entry = Find(runno, monitor);
+  if (!entry)
+  {
+    return nullptr;
+  }
+  const KeyEntry *found = nullptr;
+  for (auto &key : entry->keys)
+  {
+    if (key.name == hname && (!found || key.cycle > found->cycle))
+    {
+      found = &key;
+    }
+  }
+  return found;
+}
+
+std::set<int> OnlMonFileIndex::Runs(const std::string &monitor) const
+{
+  std::set<int> runs;
+  for (auto &runiter : m_RunMonitorFile)
+  {
+    if (monitor.empty() || runiter.first.second == monitor)
+    {
+      runs.insert(runiter.first.first);
+    }
+  }
+  return runs;
+}
+
+std::vector<const OnlMonFileIndex::FileEntry *> OnlMonFileIndex::Files(const int runno) const
+{
+  std::vector<const FileEntry *> files;
+  for (auto runiter = m_RunMonitorFile.lower_bound(std::make_pair(runno, std::string()));
+       runiter != m_RunMonitorFile.end() && runiter->first.first == runno; ++runiter)
+  {
+    files.push_back(&m_Files.find(runiter->second)->second);
+  }
+  return files;
+}
+
+void OnlMonFileIndex::identify(std::ostream &os) const
+{
+  os << "OnlMonFileIndex " << m_IndexFile << ": " << m_Files.size() << " files, "
+     << m_RunMonitorFile.size() << " run/monitor combinations" << std::endl;
+  if (m_Verbosity > 0)
+  {
+    for (auto &fileiter : m_Files)
+    {
+      os << "  run " << fileiter.second.run << " " << fileiter.second.monitor
+         << ": " << fileiter.first << ", " << fileiter.second.keys.size() << " keys" << std::endl;
+    }
+  }
+}
@@ -0,0 +1,90 @@
+#ifndef ONLMONCLIENT_ONLMONFILEINDEX_H
+#define ONLMONCLIENT_ONLMONFILEINDEX_H
+
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+Index of the Run_<run>-<monitor>.root histogram files below the
+ONLMON_SAVEDIR tree. For every file it keeps the run, the monitor,
+size, modification time and the names, classes and sizes of the
+objects stored in it, so the run list and the file containing a
+given histogram are known without listing directories or opening
+files.
+
+The index is kept as a text file (one line per histogram file
+followed by one indented line per key), a rescan only opens files
+which are new or whose size or modification time changed:
+
+  OnlMonFileIndex idx("/path/onlmon_histo.index");
+  idx.Read();
+  if (idx.Scan("/path/histograms") >= 0)
+  {
+    idx.Write();
+  }
+*/
+
+class OnlMonFileIndex
+{
+ public:
+  struct KeyEntry
+  {
+    std::string name;
+    std::string classname;
+    int cycle = 0;
+    int objlen = 0;  // uncompressed size
+    int nbytes = 0;  // size on disk
+  };
+
+  struct FileEntry
+  {
+    std::string filename;
+    int run = 0;
+    std::string monitor;
+    long size = 0;
+    time_t mtime = 0;
+    std::vector<KeyEntry> keys;
+  };
+
+  explicit OnlMonFileIndex(const std::string &indexfile = "");
+  virtual ~OnlMonFileIndex() = default;
+
+  //! default index file, $ONLMON_SAVEDIR/onlmon_histo.index
+  static std::string DefaultIndexFile();
+  //! run and monitor from Run_<run>-<monitor>.root, returns -1 for other files
+  static int ParseFileName(const std::string &filename, int &runno, std::string &monitor);
+
+  const std::string &IndexFile() const { return m_IndexFile; }
+  int Read();
+  int Write() const;
+  //! (re)indexes new and modified files below topdir and drops removed ones,
+  //! returns the number of files which were opened. If topdir cannot be read
+  //! completely nothing is dropped and -1 is returned, do not Write() then
+  int Scan(const std::string &topdir);
+
+  const FileEntry *Find(const int runno, const std::string &monitor) const;
+  const KeyEntry *FindKey(const int runno, const std::string &monitor, const std::string &hname) const;
+  std::set<int> Runs(const std::string &monitor = "") const;
+  std::vector<const FileEntry *> Files(const int runno) const;
+  unsigned int NFiles() const { return m_Files.size(); }
+  void Verbosity(const int i) { m_Verbosity = i; }
+  void identify(std::ostream &os = std::cout) const;
+
+ protected:
+  int IndexKeys(FileEntry &entry) const;
+  void BuildRunMap();
+
+  int m_Verbosity = 0;
+  std::string m_IndexFile;
+  // filename -> file entry
+  std::map<std::string, FileEntry> m_Files;
+  // (run, monitor) -> filename, the newest file wins if there are several
+  std::map<std::pair<int, std::string>, std::string> m_RunMonitorFile;
+};
+
+#endif /* ONLMONCLIENT_ONLMONFILEINDEX_H */
@@ -5,6 +5,7 @@
 #include <dirent.h>
 #include <sys/stat.h>
 #include <algorithm>
+#include <cstdio>   // for remove
 #include <cstddef>  // for size_t
 #include <fstream>
 #include <iomanip>
@@ -92,6 +93,24 @@ OnlMonHtml::~OnlMonHtml()
 //_____________________________________________________________________________
 void OnlMonHtml::addMenu(const std::string& header, const std::string& path,
                          const std::string& relfilename)
+{
+  std::ostringstream sline;
+  sline << header << "/" << path << "/" << relfilename;
+
+  // forked html workers must not rewrite the common menu file, their
+  // entries are collected and merged by the parent when they are done
+  if (fMenuWorker >= 0)
+  {
+    fDeferredMenu.insert(sline.str());
+    return;
+  }
+  std::vector<std::string> newlines;
+  newlines.push_back(sline.str());
+  mergeMenu(newlines);
+}
+
+//_____________________________________________________________________________
+void OnlMonHtml::mergeMenu(const std::vector<std::string>& newlines)
 {
   std::ostringstream menufile;
 
@@ -126,11 +145,8 @@ void OnlMonHtml::addMenu(const std::string& header, const std::string& path,
   }
   in.close();
 
-  // ... we then append the requested new entry...
-  std::ostringstream sline;
-  sline << header << "/" << path << "/" << relfilename;
-
-  lines.push_back(sline.str());
+  // ... we then append the requested new entries...
+  lines.insert(lines.end(), newlines.begin(), newlines.end());
 
   // ... and we sort this out...
   sort(lines.begin(), lines.end());
@@ -154,6 +170,64 @@ void OnlMonHtml::addMenu(const std::string& header, const std::string& path,
   plainHtmlMenu(olines);
 }
 
+//_____________________________________________________________________________
+std::string
+OnlMonHtml::workerMenuFile(const int worker) const
+{
+  return fHtmlRunDir + "/menu.worker" + std::to_string(worker);
+}
+
+//_____________________________________________________________________________
+void OnlMonHtml::deferMenu(const int worker)
+{
+  fMenuWorker = worker;
+  fDeferredMenu.clear();
+}
+
+//_____________________________________________________________________________
+int OnlMonHtml::writeDeferredMenu()
+{
+  if (fMenuWorker < 0)
+  {
+    return 0;
+  }
+  std::ofstream out(workerMenuFile(fMenuWorker));
+  if (!out.good())
+  {
+    std::cout << __PRETTY_FUNCTION__ << " cannot open output file "
+              << workerMenuFile(fMenuWorker) << std::endl;
+    return -1;
+  }
+  copy(fDeferredMenu.begin(), fDeferredMenu.end(), std::ostream_iterator<std::string>(out, "\n"));
+  out.close();
+  return 0;
+}
+
+//_____________________________________________________________________________
+void OnlMonHtml::mergeWorkerMenus(const int nworkers)
+{
+  std::vector<std::string> newlines;
+  for (int i = 0; i < nworkers; i++)
+  {
+    std::ifstream in(workerMenuFile(i));
+    if (!in.good())
+    {
+      continue;
+    }
+    std::string line;
+    while (std::getline(in, line))
+    {
+      newlines.push_back(line);
+    }
+    in.close();
+    remove(workerMenuFile(i).c_str());
+  }
+  if (!newlines.empty())
+  {
+    mergeMenu(newlines);
+  }
+}
+
 //_____________________________________________________________________________
 void OnlMonHtml::plainHtmlMenu(const std::set<std::string>& olines)
 {
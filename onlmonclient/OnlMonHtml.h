@@ -3,6 +3,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 class RunDBodbc;
 
@@ -54,6 +55,20 @@ class OnlMonHtml
                            const std::string& basefilename,
                            const std::string& ext);
 
+  /** Collect the menu entries in memory instead of updating the menu
+   *  file, used by forked html workers which would otherwise overwrite
+   *  each others menu updates.
+   *  @param worker number of the worker, negative switches back to
+   *  direct menu file updates
+   */
+  void deferMenu(const int worker);
+
+  /// Write the collected menu entries of this worker to its own file
+  int writeDeferredMenu();
+
+  /// Merge the menu entries of workers 0..nworkers-1 into the menu file
+  void mergeWorkerMenus(const int nworkers);
+
   void runNumber(const int runnumber);
   int runNumber() const { return fRunNumber; }
 
@@ -61,7 +76,9 @@ class OnlMonHtml
   int verbosity() const { return fVerbosity; }
 
  protected:
+  void mergeMenu(const std::vector<std::string>& newlines);
   void plainHtmlMenu(const std::set<std::string>&);
+  std::string workerMenuFile(const int worker) const;
   void runInit();
   std::string runRange();
 
@@ -69,9 +86,11 @@ class OnlMonHtml
 
   int fVerbosity = 0;
   int fRunNumber = 0;
+  int fMenuWorker = -1;
 
   std::string fHtmlDir;
   std::string fHtmlRunDir;
+  std::set<std::string> fDeferredMenu;
 };
 
 #endif
@@ -0,0 +1,124 @@
+// scans, rescans and rereads the histogram file index of a temporary
+// directory, a directory which cannot be read must not empty the index
+
+#include "OnlMonFileIndex.h"
+
+#include <onlmon/OnlMonTest.h>
+
+#include <TFile.h>
+#include <TH1.h>
+
+#include <unistd.h>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+  using OnlMonTest::Check;
+
+  void WriteHistoFile(const std::string &filename)
+  {
+    TFile f(filename.c_str(), "RECREATE");
+    TH1 *h1 = new TH1F("h1", "h1", 10, 0., 10.);
+    h1->SetDirectory(&f);
+    h1->Fill(1.);
+    f.Write();
+    f.Close();
+  }
+
+  // what makehtml.pl and ReadHistogramsFromFile users did without the index
+  std::string ScanFor(const std::string &topdir, const int runno, const std::string &monitor)
+  {
+    for (auto &entry : std::filesystem::recursive_directory_iterator(topdir))
+    {
+      int filerun;
+      std::string filemonitor;
+      if (!OnlMonFileIndex::ParseFileName(entry.path().string(), filerun, filemonitor) &&
+          filerun == runno && filemonitor == monitor)
+      {
+        return entry.path().string();
+      }
+    }
+    return "";
+  }
+}  // namespace
+
+int main()
+{
+  char tmpl[] = "/tmp/testfileindexXXXXXX";
+  if (!mkdtemp(tmpl))
+  {
+    std::cout << "cannot create temporary directory" << std::endl;
+    return 1;
+  }
+  std::string topdir = tmpl;
+  std::filesystem::create_directory(topdir + "/TESTMON");
+  WriteHistoFile(topdir + "/TESTMON/Run_1-TESTMON_0.root");
+  WriteHistoFile(topdir + "/TESTMON/Run_2-TESTMON_0.root");
+  WriteHistoFile(topdir + "/TESTMON/notahistofile.root");
+  std::string indexfile = topdir + "/onlmon_histo.index";
+
+  OnlMonFileIndex idx(indexfile);
+  Check(idx.Scan(topdir) == 2, "first scan opens all histogram files");
+  Check(idx.NFiles() == 2 && idx.Runs("TESTMON_0") == std::set<int>({1, 2}), "both runs are indexed");
+  Check(idx.FindKey(2, "TESTMON_0", "h1") != nullptr, "keys are indexed");
+  Check(idx.Scan(topdir) == 0, "rescan does not open unchanged files");
+  Check(idx.Write() == 0, "index is written");
+
+  OnlMonFileIndex reread(indexfile);
+  Check(reread.Read() == 0 && reread.NFiles() == 2 && reread.FindKey(1, "TESTMON_0", "h1") != nullptr, "index is read back");
+
+  Check(idx.Scan(topdir + "/doesnotexist") < 0, "scan of a missing directory fails");
+  Check(idx.NFiles() == 2, "failed scan keeps the index");
+
+  std::filesystem::remove(topdir + "/TESTMON/Run_2-TESTMON_0.root");
+  Check(idx.Scan(topdir) == 0 && idx.NFiles() == 1 && idx.Find(2, "TESTMON_0") == nullptr, "removed files are dropped");
+
+  int runno = 0;
+  std::string monitor;
+  Check(OnlMonFileIndex::ParseFileName("Run_12345678901234567890-TESTMON_0.root", runno, monitor) != 0, "overlong run numbers are no histogram files");
+  Check(OnlMonFileIndex::ParseFileName("/some/dir/Run_123456789-TESTMON_0.root", runno, monitor) == 0 && runno == 123456789 && monitor == "TESTMON_0", "run and monitor from the file name");
+
+  // lookup in the index against a directory scan, 100 runs of 5 monitors
+  for (int monitornum = 0; monitornum < 5; monitornum++)
+  {
+    std::string subdir = topdir + "/MON" + std::to_string(monitornum);
+    std::filesystem::create_directory(subdir);
+    for (int run = 100; run < 200; run++)
+    {
+      WriteHistoFile(subdir + "/Run_" + std::to_string(run) + "-MON" + std::to_string(monitornum) + ".root");
+    }
+  }
+  Check(idx.Scan(topdir) == 500, "new files are indexed");
+  const int nlookups = 100;
+  std::vector<std::string> indexfiles(nlookups);
+  std::vector<std::string> scanfiles(nlookups);
+  auto indexlookup = [&]()
+  {
+    for (int i = 0; i < nlookups; i++)
+    {
+      const OnlMonFileIndex::FileEntry *entry = idx.Find(100 + i, "MON" + std::to_string(i % 5));
+      indexfiles[i] = (entry) ? entry->filename : "";
+    }
+  };
+  auto scanlookup = [&]()
+  {
+    for (int i = 0; i < nlookups; i++)
+    {
+      scanfiles[i] = ScanFor(topdir, 100 + i, "MON" + std::to_string(i % 5));
+    }
+  };
+  double indexseconds = OnlMonTest::Seconds(indexlookup);
+  double scanseconds = OnlMonTest::Seconds(scanlookup);
+  std::cout << nlookups << " lookups of 501 files: " << indexseconds << " s in the index, "
+            << scanseconds << " s scanning the directories" << std::endl;
+  Check(indexfiles == scanfiles && !indexfiles[0].empty(), "index and directory scan find the same files");
+  Check(indexseconds < scanseconds, "index lookup is faster than the directory scan");
+
+  std::filesystem::remove_all(topdir);
+  return (OnlMonTest::Summary()) ? 1 : 0;
+}
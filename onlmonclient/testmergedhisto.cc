@@ -0,0 +1,190 @@
+// compares the incremental merge of ClientMergedHisto with the brute force
+// merge of all sources after random updates of the sources
+
+#include "ClientHistoList.h"
+#include "ClientMergedHisto.h"
+
+#include <onlmon/OnlMonTest.h>
+
+#include <TH1.h>
+#include <TH2.h>
+#include <TRandom3.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  TRandom3 rnd(4711);
+
+  TH1 *NewSource(const TH1 *proto, const TH1 *previous)
+  {
+    TH1 *h = static_cast<TH1 *>(proto->Clone());
+    h->SetDirectory(nullptr);
+    if (previous && rnd.Rndm() < 0.8)
+    {
+      // what the server sends after more events
+      h->Add(previous);
+    }
+    int nfill = rnd.Integer(50);
+    for (int i = 0; i < nfill; i++)
+    {
+      int bin = rnd.Integer(h->GetNcells());
+      double w = rnd.Uniform(-1., 5.);
+      h->AddBinContent(bin, w);
+      if (h->GetSumw2N())
+      {
+        h->GetSumw2()->fArray[bin] += w * w;
+      }
+    }
+    h->SetEntries(h->GetEntries() + nfill);
+    return h;
+  }
+
+  int Compare(const TH1 *merged, const std::vector<ClientHistoList *> &lists, const ClientMergedHisto::MergeOp op, const std::string &what)
+  {
+    std::vector<const TH1 *> src;
+    for (auto l : lists)
+    {
+      if (l->Histo())
+      {
+        src.push_back(l->Histo());
+      }
+    }
+    if (src.empty())
+    {
+      return (merged) ? 1 : 0;
+    }
+    if (!merged)
+    {
+      std::cout << what << ": no merged histogram" << std::endl;
+      return 1;
+    }
+    bool errors = true;
+    for (auto h : src)
+    {
+      errors = errors && (h->GetSumw2N() == h->GetNcells());
+    }
+    int nbad = 0;
+    for (int bin = 0; bin < merged->GetNcells(); bin++)
+    {
+      double val = src[0]->GetBinContent(bin);
+      double w2 = src[0]->GetBinError(bin) * src[0]->GetBinError(bin);
+      for (unsigned int k = 1; k < src.size(); k++)
+      {
+        double v = src[k]->GetBinContent(bin);
+        double e2 = src[k]->GetBinError(bin) * src[k]->GetBinError(bin);
+        if (op == ClientMergedHisto::MAX)
+        {
+          if (v > val)
+          {
+            val = v;
+            w2 = e2;
+          }
+        }
+        else
+        {
+          val += v;
+          w2 += e2;
+        }
+      }
+      if (op == ClientMergedHisto::AVERAGE)
+      {
+        val /= src.size();
+        w2 /= (src.size() * src.size());
+        if (merged->InheritsFrom("TH1I"))
+        {
+          // integer bins cannot store the average
+          val = static_cast<int>(val);
+        }
+      }
+      double tolerance = 1e-5 * (1. + std::fabs(val));
+      bool bad = std::fabs(merged->GetBinContent(bin) - val) > tolerance;
+      if (errors)
+      {
+        bad = bad || std::fabs(merged->GetBinError(bin) - std::sqrt(w2)) > 1e-5 * (1. + std::sqrt(w2));
+      }
+      if (bad && nbad++ < 5)
+      {
+        std::cout << what << ": bin " << bin << " merged " << merged->GetBinContent(bin)
+                  << " +- " << merged->GetBinError(bin) << ", expected " << val
+                  << " +- " << std::sqrt(w2) << std::endl;
+      }
+    }
+    return nbad;
+  }
+
+  int Run(const TH1 *proto, const ClientMergedHisto::MergeOp op, const std::string &what)
+  {
+    const unsigned int nsrc = 6;
+    ClientMergedHisto merged(proto->GetName(), op);
+    std::vector<ClientHistoList *> lists;
+    std::vector<const ClientHistoList *> srclist;
+    for (unsigned int k = 0; k < nsrc; k++)
+    {
+      merged.AddSource("SRC_" + std::to_string(k), proto->GetName());
+      lists.push_back(new ClientHistoList());
+      srclist.push_back(lists.back());
+    }
+    int nfail = 0;
+    for (int iter = 0; iter < 40; iter++)
+    {
+      for (auto l : lists)
+      {
+        double r = rnd.Rndm();
+        TH1 *old = l->Histo();
+        if (r < 0.4)
+        {
+          l->Histo(NewSource(proto, old));
+          delete old;
+        }
+        else if (r < 0.45)
+        {
+          // server reset
+          l->Histo(NewSource(proto, nullptr));
+          delete old;
+        }
+        else if (r < 0.47 && iter > 0)
+        {
+          // server went away
+          l->Histo(nullptr);
+          delete old;
+        }
+      }
+      int nbad = Compare(merged.Update(srclist), lists, op, what + " iteration " + std::to_string(iter));
+      // nothing changed, the merge has to stay the same
+      nbad += Compare(merged.Update(srclist), lists, op, what + " repeated iteration " + std::to_string(iter));
+      if (nbad)
+      {
+        nfail++;
+      }
+    }
+    for (auto l : lists)
+    {
+      delete l;
+    }
+    OnlMonTest::Check(nfail == 0, what);
+    return nfail;
+  }
+}  // namespace
+
+int main()
+{
+  TH1::AddDirectory(false);
+  const char *opname[] = {"SUM", "MAX", "AVERAGE"};
+  for (auto op : {ClientMergedHisto::SUM, ClientMergedHisto::MAX, ClientMergedHisto::AVERAGE})
+  {
+    TH2F h2("h2", "2d with errors", 30, 0., 30., 20, 0., 20.);
+    h2.Sumw2();
+    Run(&h2, op, std::string("TH2F errors ") + opname[op]);
+    TH1I h1("h1", "1d without errors", 100, 0., 100.);
+    Run(&h1, op, std::string("TH1I ") + opname[op]);
+    // large enough for the parallel merge
+    TH1D hlarge("hlarge", "parallel", 2 * ClientMergedHisto::PARALLELCELLS, 0., 1.);
+    hlarge.Sumw2();
+    Run(&hlarge, op, std::string("TH1D parallel ") + opname[op]);
+  }
+  return (OnlMonTest::Summary()) ? 1 : 0;
+}
@@ -0,0 +1,210 @@
+// runs ClientHistoPrefetch against a stand-in server which speaks the
+// VERSIONS and LIST part of the server protocol
+
+#include "ClientHistoPrefetch.h"
+
+#include <onlmon/OnlMonDefs.h>
+#include <onlmon/OnlMonTest.h>
+
+#include <MessageTypes.h>
+#include <TH1.h>
+#include <TMessage.h>
+#include <TROOT.h>
+#include <TServerSocket.h>
+#include <TSocket.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace
+{
+  const std::string monitor = "TESTMON";
+  using OnlMonTest::Check;
+
+  class StandInServer
+  {
+   public:
+    StandInServer()
+    {
+      for (port = OnlMonDefs::MONIPORT + 100; port < OnlMonDefs::MONIPORT + 200; port++)
+      {
+        socket = new TServerSocket(port, kTRUE);
+        if (socket->IsValid())
+        {
+          break;
+        }
+        delete socket;
+        socket = nullptr;
+      }
+      worker = std::thread(&StandInServer::Serve, this);
+    }
+    ~StandInServer()
+    {
+      stop = true;
+      worker.join();
+      delete socket;
+      for (auto &hiter : histos)
+      {
+        delete hiter.second;
+      }
+    }
+    void Add(const std::string &hname, const unsigned int version)
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      TH1 *h1 = new TH1F(hname.c_str(), hname.c_str(), 10, 0., 10.);
+      h1->SetDirectory(nullptr);
+      h1->Fill(1.);
+      histos[hname] = h1;
+      versions[hname] = version;
+    }
+    void Delay(const int ms) { delay = ms; }
+    int port = 0;
+
+   private:
+    void Serve()
+    {
+      while (!stop)
+      {
+        if (!socket || socket->Select(TSocket::kRead, 100) <= 0)
+        {
+          continue;
+        }
+        TSocket *sock = socket->Accept();
+        if (sock && sock->IsValid())
+        {
+          Handle(sock);
+        }
+        delete sock;
+      }
+    }
+    void Handle(TSocket *sock)
+    {
+      TMessage *mess = nullptr;
+      char str[OnlMonDefs::MSGLEN];
+      while (sock->Recv(mess) > 0 && mess)
+      {
+        mess->ReadString(str, OnlMonDefs::MSGLEN);
+        delete mess;
+        mess = nullptr;
+        std::string command = str;
+        if (command == "Finished")
+        {
+          break;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        if (command == "VERSIONS " + monitor)
+        {
+          for (auto &viter : versions)
+          {
+            sock->Send((viter.first + ' ' + std::to_string(viter.second)).c_str());
+            sock->Recv(mess);
+            delete mess;
+            mess = nullptr;
+          }
+          sock->Send("Finished");
+        }
+        else if (command == "LIST")
+        {
+          std::this_thread::sleep_for(std::chrono::milliseconds(delay.load()));
+          sock->Send("go");
+          while (sock->Recv(mess) > 0 && mess)
+          {
+            mess->ReadString(str, OnlMonDefs::MSGLEN);
+            delete mess;
+            mess = nullptr;
+            std::string subsyshisto = str;
+            if (subsyshisto == "alldone")
+            {
+              break;
+            }
+            auto hiter = histos.find(subsyshisto.substr(subsyshisto.find(' ') + 1));
+            if (hiter == histos.end())
+            {
+              sock->Send("UnknownHisto");
+              continue;
+            }
+            TMessage outgoing(kMESS_OBJECT);
+            outgoing.WriteObject(hiter->second);
+            sock->Send(outgoing);
+          }
+          sock->Send("Finished");
+        }
+      }
+      delete mess;
+    }
+    std::atomic<bool> stop{false};
+    std::atomic<int> delay{0};
+    TServerSocket *socket = nullptr;
+    std::map<std::string, TH1 *> histos;
+    std::map<std::string, unsigned int> versions;
+    std::mutex mtx;
+    std::thread worker;
+  };
+
+  ClientHistoPrefetch::Request MakeRequest(const StandInServer &server, const std::map<std::string, unsigned int> &versions)
+  {
+    ClientHistoPrefetch::Request request;
+    request.subsys = monitor;
+    request.hostname = "localhost";
+    request.port = server.port;
+    request.versions = versions;
+    return request;
+  }
+
+  void Clear(ClientHistoPrefetch::Result &result)
+  {
+    for (auto &hiter : result.histos)
+    {
+      delete hiter.second;
+    }
+    result = ClientHistoPrefetch::Result();
+  }
+}  // namespace
+
+int main()
+{
+  ROOT::EnableThreadSafety();
+  TH1::AddDirectory(false);
+  StandInServer server;
+  server.Add("h1", 3);
+  server.Add("h2", 5);
+
+  ClientHistoPrefetch prefetch;
+  ClientHistoPrefetch::Result result;
+  Check(prefetch.Take(monitor, result, 60) != 0, "nothing to take before anything was scheduled");
+
+  // the client has h2 in the version of the server, zgone is not on the server
+  prefetch.Schedule({MakeRequest(server, {{"h1", 0}, {"h2", 5}, {"zgone", 2}})});
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  Check(prefetch.Take(monitor, result, 60) == 0, "prefetched histograms are taken");
+  Check(result.histos.size() == 1 && result.histos.count("h1") && result.versions["h1"] == 3, "only the changed histogram is transferred");
+  Check(result.requested == std::set<std::string>({"h1", "zgone"}), "histograms missing on the server are reported");
+  Clear(result);
+  Check(prefetch.Take(monitor, result, 60) != 0, "a result is only taken once");
+
+  prefetch.Schedule({MakeRequest(server, {{"h1", 0}})});
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  Check(prefetch.Take(monitor, result, -1) != 0, "results older than maxage are dropped");
+  Clear(result);
+
+  // the gui must not wait for a fetch in flight
+  server.Delay(3000);
+  prefetch.Schedule({MakeRequest(server, {{"h1", 0}})});
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  auto start = std::chrono::steady_clock::now();
+  int iret = prefetch.Take(monitor, result, 60);
+  std::chrono::duration<double> blocked = std::chrono::steady_clock::now() - start;
+  Check(iret != 0 && blocked.count() < 1., "Take does not block while the monitor is fetched");
+  std::this_thread::sleep_for(std::chrono::seconds(4));
+  Check(prefetch.Take(monitor, result, 60) != 0, "the fetch the caller gave up on is dropped");
+  Clear(result);
+
+  return (OnlMonTest::Summary()) ? 1 : 0;
+}
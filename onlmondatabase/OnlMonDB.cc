@@ -1,4 +1,5 @@
 #include "OnlMonDB.h"
+#include "OnlMonDBReturnCodes.h"
 #include "OnlMonDBVar.h"
 #include "OnlMonDBodbc.h"
 
@@ -9,6 +10,7 @@
 #include <algorithm>
 #include <cstdio>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <utility>  // for pair
 
@@ -87,6 +89,11 @@ int OnlMonDB::DBInit()
   return 0;
 }
 
+bool OnlMonDB::Connected()
+{
+  return OnlMonDBodbc::Connected();
+}
+
 int OnlMonDB::DBcommit()
 {
   OnlMonServer *se = OnlMonServer::instance();
@@ -152,13 +159,224 @@ int OnlMonDB::DBcommitTest()
 }
 
 int OnlMonDB::GetVar(const time_t begin, const time_t end, const std::string &varname, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<float> &var, std::vector<float> &varerr)
+{
+  if (!m_UseCache)
+  {
+    return QueryVar(begin, end, varname, timestp, runnumber, var, varerr);
+  }
+  VarCache &cache = m_VarCache[varname];
+  cache.lastuse = ++m_CacheUses;
+  if (begin < cache.tbegin || end < cache.tend || cache.tend <= cache.tbegin)
+  {
+    cache = VarCache();
+    cache.lastuse = m_CacheUses;
+    cache.tbegin = begin;
+    cache.tend = begin;
+  }
+  // the rows of the trailing window may still be added or updated, they are read again
+  time_t qbegin = std::max(cache.tbegin, cache.tend - m_CacheLatency);
+  std::vector<time_t> newtimestp;
+  std::vector<int> newrunnumber;
+  std::vector<float> newvar;
+  std::vector<float> newvarerr;
+  for (int iread = 0; iread < 2 && end > qbegin + 1; iread++)
+  {
+    int iret = QueryVar(qbegin, end, varname, newtimestp, newrunnumber, newvar, newvarerr);
+    if (iret && iret != DBNOENTRIES)
+    {
+      m_VarCache.erase(varname);
+      timestp.clear();
+      runnumber.clear();
+      var.clear();
+      varerr.clear();
+      return iret;
+    }
+    if (Verbosity() > 0)
+    {
+      std::cout << __PRETTY_FUNCTION__ << " " << varname << ": " << cache.timestp.size()
+                << " cached rows, " << newtimestp.size() << " read from db" << std::endl;
+    }
+    // late rows of the previous run which are older than the trailing window
+    // are picked up by reading everything again once a new run started
+    if (qbegin == cache.tbegin || cache.runnumber.empty() || newrunnumber.empty() ||
+        newrunnumber.back() == cache.runnumber.back())
+    {
+      break;
+    }
+    EraseRows(cache, 0, cache.timestp.size());
+    qbegin = cache.tbegin;
+  }
+  unsigned int keep = std::upper_bound(cache.timestp.begin(), cache.timestp.end(), qbegin) - cache.timestp.begin();
+  EraseRows(cache, keep, cache.timestp.size());
+  cache.timestp.insert(cache.timestp.end(), newtimestp.begin(), newtimestp.end());
+  cache.runnumber.insert(cache.runnumber.end(), newrunnumber.begin(), newrunnumber.end());
+  cache.var.insert(cache.var.end(), newvar.begin(), newvar.end());
+  cache.varerr.insert(cache.varerr.end(), newvarerr.begin(), newvarerr.end());
+  cache.tend = end;
+  auto first = std::upper_bound(cache.timestp.begin(), cache.timestp.end(), begin) - cache.timestp.begin();
+  timestp.assign(cache.timestp.begin() + first, cache.timestp.end());
+  runnumber.assign(cache.runnumber.begin() + first, cache.runnumber.end());
+  var.assign(cache.var.begin() + first, cache.var.end());
+  varerr.assign(cache.varerr.begin() + first, cache.varerr.end());
+  TrimCache(varname, begin);
+  if (timestp.empty())
+  {
+    return DBNOENTRIES;
+  }
+  return DBOKAY;
+}
+
+int OnlMonDB::QueryVar(const time_t begin, const time_t end, const std::string &varname, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<float> &var, std::vector<float> &varerr)
 {
   if (!db)
   {
     db = new OnlMonDBodbc(ThisName);
   }
-  int iret = db->GetVar(begin, end, varname, timestp, runnumber, var, varerr);
-  return iret;
+  return db->GetVar(begin, end, varname, timestp, runnumber, var, varerr);
+}
+
+void OnlMonDB::CacheLatency(const int i)
+{
+  m_CacheLatency = std::max(i, OnlMonDBodbc::UpdateInterval());
+  return;
+}
+
+unsigned int OnlMonDB::CachedRows() const
+{
+  unsigned int nrows = 0;
+  for (auto &cacheiter : m_VarCache)
+  {
+    nrows += cacheiter.second.timestp.size();
+  }
+  return nrows;
+}
+
+int OnlMonDB::GetVars(const time_t begin, const time_t end, const std::vector<std::string> &varnames, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<std::vector<float>> &var, std::vector<std::vector<float>> &varerr)
+{
+  if (!m_UseCache)
+  {
+    return QueryVars(begin, end, varnames, timestp, runnumber, var, varerr);
+  }
+  // the cache is per variable, its rows are aligned again by their time stamps
+  // (GetVar skips the rows where the variable is not set)
+  unsigned int nvars = varnames.size();
+  std::vector<std::vector<time_t>> vartimestp(nvars);
+  std::vector<std::vector<int>> varrunnumber(nvars);
+  std::vector<std::vector<float>> varval(nvars);
+  std::vector<std::vector<float>> varvalerr(nvars);
+  timestp.clear();
+  runnumber.clear();
+  var.assign(nvars, std::vector<float>());
+  varerr.assign(nvars, std::vector<float>());
+  for (unsigned int i = 0; i < nvars; i++)
+  {
+    int iret = GetVar(begin, end, varnames[i], vartimestp[i], varrunnumber[i], varval[i], varvalerr[i]);
+    if (iret && iret != DBNOENTRIES)
+    {
+      return iret;
+    }
+  }
+  std::vector<unsigned int> next(nvars, 0);
+  while (true)
+  {
+    unsigned int ifirst = nvars;
+    for (unsigned int i = 0; i < nvars; i++)
+    {
+      if (next[i] < vartimestp[i].size() && (ifirst == nvars || vartimestp[i][next[i]] < vartimestp[ifirst][next[ifirst]]))
+      {
+        ifirst = i;
+      }
+    }
+    if (ifirst == nvars)
+    {
+      break;
+    }
+    time_t rowtime = vartimestp[ifirst][next[ifirst]];
+    timestp.push_back(rowtime);
+    runnumber.push_back(varrunnumber[ifirst][next[ifirst]]);
+    for (unsigned int i = 0; i < nvars; i++)
+    {
+      if (next[i] < vartimestp[i].size() && vartimestp[i][next[i]] == rowtime)
+      {
+        var[i].push_back(varval[i][next[i]]);
+        varerr[i].push_back(varvalerr[i][next[i]]);
+        next[i]++;
+      }
+      else
+      {
+        var[i].push_back(std::numeric_limits<float>::quiet_NaN());
+        varerr[i].push_back(std::numeric_limits<float>::quiet_NaN());
+      }
+    }
+  }
+  if (timestp.empty())
+  {
+    return DBNOENTRIES;
+  }
+  return DBOKAY;
+}
+
+int OnlMonDB::QueryVars(const time_t begin, const time_t end, const std::vector<std::string> &varnames, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<std::vector<float>> &var, std::vector<std::vector<float>> &varerr)
+{
+  if (!db)
+  {
+    db = new OnlMonDBodbc(ThisName);
+  }
+  return db->GetVars(begin, end, varnames, timestp, runnumber, var, varerr);
+}
+
+int OnlMonDB::GetVarTrend(const time_t begin, const time_t end, const std::string &varname, const unsigned int nbuckets, std::vector<time_t> &bucket, std::vector<float> &varmin, std::vector<float> &varmax, std::vector<float> &varmean, std::vector<int> &count)
+{
+  if (!db)
+  {
+    db = new OnlMonDBodbc(ThisName);
+  }
+  return db->GetVarTrend(begin, end, varname, nbuckets, bucket, varmin, varmax, varmean, count);
+}
+
+void OnlMonDB::TrimCache(const std::string &varname, const time_t begin)
+{
+  // history windows move forward, older rows are not asked for again
+  VarCache &cache = m_VarCache[varname];
+  unsigned int drop = std::upper_bound(cache.timestp.begin(), cache.timestp.end(), begin) - cache.timestp.begin();
+  EraseRows(cache, 0, drop);
+  cache.tbegin = std::max(cache.tbegin, begin);
+  // the least recently used variables go first, then the oldest rows of this one
+  unsigned int nrows = CachedRows();
+  while (nrows > m_CacheMaxRows)
+  {
+    auto oldest = m_VarCache.end();
+    for (auto cacheiter = m_VarCache.begin(); cacheiter != m_VarCache.end(); ++cacheiter)
+    {
+      if (cacheiter->first != varname && (oldest == m_VarCache.end() || cacheiter->second.lastuse < oldest->second.lastuse))
+      {
+        oldest = cacheiter;
+      }
+    }
+    if (oldest == m_VarCache.end())
+    {
+      drop = nrows - m_CacheMaxRows;
+      cache.tbegin = cache.timestp[drop - 1];
+      EraseRows(cache, 0, drop);
+      break;
+    }
+    nrows -= oldest->second.timestp.size();
+    m_VarCache.erase(oldest);
+  }
+  return;
+}
+
+void OnlMonDB::EraseRows(VarCache &cache, const unsigned int first, const unsigned int last)
+{
+  if (first >= last)
+  {
+    return;
+  }
+  cache.timestp.erase(cache.timestp.begin() + first, cache.timestp.begin() + last);
+  cache.runnumber.erase(cache.runnumber.begin() + first, cache.runnumber.begin() + last);
+  cache.var.erase(cache.var.begin() + first, cache.var.begin() + last);
+  cache.varerr.erase(cache.varerr.begin() + first, cache.varerr.begin() + last);
+  return;
 }
 
 void OnlMonDB::Reset()
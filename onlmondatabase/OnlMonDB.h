@@ -25,12 +25,55 @@ class OnlMonDB : public OnlMonBase
   int DBInit();
   void Print() const;
   int GetVar(const time_t begin, const time_t end, const std::string &varname, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<float> &var, std::vector<float> &varerr);
+  // several variables of this table in one db query, var[i] belongs to varnames[i]
+  // (NaN where it was not set), all aligned with timestp. With UseCache the
+  // variables come from the cache of GetVar
+  int GetVars(const time_t begin, const time_t end, const std::vector<std::string> &varnames, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<std::vector<float>> &var, std::vector<std::vector<float>> &varerr);
+  // min, max, mean and number of entries of varname in nbuckets time bins (e.g. the
+  // pixel width of the plot) for long time ranges, instead of every row
+  int GetVarTrend(const time_t begin, const time_t end, const std::string &varname, const unsigned int nbuckets, std::vector<time_t> &bucket, std::vector<float> &varmin, std::vector<float> &varmax, std::vector<float> &varmean, std::vector<int> &count);
   void Reset();  // reset variables (set update flag to 0 to not mix runs)
+  // GetVar keeps the rows it read and only asks the db for the rows of the trailing
+  // CacheLatency seconds again, off by default. Servers commit rows with the event
+  // time (they lag or replay old data) and update rows for OnlMonDBodbc::UpdateInterval,
+  // rows older than that which show up later are only seen after the next run starts
+  // (the whole range is read again then)
+  void UseCache(const int i) { m_UseCache = i; }
+  // seconds of rows which are read again on every call, at least OnlMonDBodbc::UpdateInterval
+  void CacheLatency(const int i);
+  // maximum number of cached rows of all variables, the least recently used are dropped
+  void CacheMaxRows(const unsigned int i) { m_CacheMaxRows = i; }
+  unsigned int CachedRows() const;
+  void ClearCache() { m_VarCache.clear(); }
+  // true while a db connection is open (it must not be shared with forked processes)
+  static bool Connected();
 
  protected:
+  // the db query of GetVar, rows with begin < timestp < end
+  virtual int QueryVar(const time_t begin, const time_t end, const std::string &varname, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<float> &var, std::vector<float> &varerr);
+  // the db query of GetVars
+  virtual int QueryVars(const time_t begin, const time_t end, const std::vector<std::string> &varnames, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<std::vector<float>> &var, std::vector<std::vector<float>> &varerr);
+  // rows with tbegin < timestp < tend, all of them in this range are cached
+  struct VarCache
+  {
+    time_t tbegin = 0;
+    time_t tend = 0;
+    unsigned long lastuse = 0;
+    std::vector<time_t> timestp;
+    std::vector<int> runnumber;
+    std::vector<float> var;
+    std::vector<float> varerr;
+  };
+  void TrimCache(const std::string &varname, const time_t begin);
+  static void EraseRows(VarCache &cache, const unsigned int first, const unsigned int last);
+
   std::map<const std::string, OnlMonDBVar *> varmap;
   OnlMonDBodbc *db = nullptr;
-  ;
+  int m_UseCache = 0;
+  int m_CacheLatency = 900;
+  unsigned int m_CacheMaxRows = 2000000;
+  unsigned long m_CacheUses = 0;
+  std::map<std::string, VarCache> m_VarCache;
 };
 
 #endif
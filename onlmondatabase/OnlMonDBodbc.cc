@@ -18,6 +18,7 @@
 #include <ctime>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <utility>  // for pair
 
@@ -607,6 +608,163 @@ int OnlMonDBodbc::GetVar(const time_t begin, const time_t end, const std::string
   return iret;
 }
 
+int OnlMonDBodbc::GetVars(const time_t begin, const time_t end, const std::vector<std::string>& varnames, std::vector<time_t>& timestp, std::vector<int>& runnumber, std::vector<std::vector<float>>& var, std::vector<std::vector<float>>& varerr)
+{
+  timestp.clear();
+  runnumber.clear();
+  var.assign(varnames.size(), std::vector<float>());
+  varerr.assign(varnames.size(), std::vector<float>());
+  if (varnames.empty())
+  {
+    return DBNOENTRIES;
+  }
+  if (GetConnection())
+  {
+    return DBNOCON;
+  }
+  odbc::Timestamp mintime(begin);
+  odbc::Timestamp maxtime(end);
+  std::ostringstream cmd;
+  cmd << "SELECT date, run";
+  for (auto& varname : varnames)
+  {
+    cmd << ", " << varname << ", " << varname << addvarname[1];
+  }
+  cmd << " FROM " << table << " WHERE date > '" << mintime.toString()
+      << "' and date < '" << maxtime.toString() << "' ORDER BY date ASC";
+#ifdef VERBOSE
+  std::cout << "Command: " << cmd.str() << std::endl;
+#endif
+  odbc::Statement* query = con->createStatement();
+  odbc::ResultSet* rs = nullptr;
+  try
+  {
+    rs = query->executeQuery(cmd.str());
+  }
+  catch (odbc::SQLException& e)
+  {
+    std::cout << "Exception caught, probably one of your variables or the table "
+              << table << " does not exist" << std::endl;
+    std::cout << "Message: " << e.getMessage() << std::endl;
+    delete query;
+    return -3;
+  }
+  std::vector<float> val(varnames.size());
+  std::vector<float> valerr(varnames.size());
+  while (rs->next())
+  {
+    time_t rowtime = rs->getTimestamp(1).getTime();
+    int rowrun = rs->getInt(2);
+    bool anyset = false;
+    for (unsigned int i = 0; i < varnames.size(); i++)
+    {
+      val[i] = rs->getFloat(2 * i + 3);
+      if (rs->wasNull())
+      {
+        val[i] = std::numeric_limits<float>::quiet_NaN();
+        valerr[i] = std::numeric_limits<float>::quiet_NaN();
+        continue;
+      }
+      anyset = true;
+      valerr[i] = rs->getFloat(2 * i + 4);
+    }
+    if (!anyset)
+    {
+      continue;
+    }
+    timestp.push_back(rowtime);
+    runnumber.push_back(rowrun);
+    for (unsigned int i = 0; i < varnames.size(); i++)
+    {
+      var[i].push_back(val[i]);
+      varerr[i].push_back(valerr[i]);
+    }
+  }
+  delete rs;
+  delete query;
+  if (timestp.empty())
+  {
+    return DBNOENTRIES;
+  }
+  return 0;
+}
+
+int OnlMonDBodbc::GetVarTrend(const time_t begin, const time_t end, const std::string& varname, const unsigned int nbuckets, std::vector<time_t>& bucket, std::vector<float>& varmin, std::vector<float>& varmax, std::vector<float>& varmean, std::vector<int>& count)
+{
+  bucket.clear();
+  varmin.clear();
+  varmax.clear();
+  varmean.clear();
+  count.clear();
+  if (nbuckets == 0 || end <= begin)
+  {
+    return DBNOENTRIES;
+  }
+  if (GetConnection())
+  {
+    return DBNOCON;
+  }
+  time_t width = (end - begin + nbuckets - 1) / nbuckets;
+  if (width < 1)
+  {
+    width = 1;
+  }
+  odbc::Timestamp mintime(begin);
+  odbc::Timestamp maxtime(end);
+  std::ostringstream cmd;
+  // the rows are reduced by the db, only one row per bucket is transferred.
+  // date is a local time without time zone, the offset has to be taken from
+  // the same literal as the WHERE clause and not from the utc epoch of begin
+  cmd << "SELECT CAST(floor((extract(epoch from date) - extract(epoch from timestamp '" << mintime.toString() << "')) / " << width << ") AS bigint) AS bucket, "
+      << "min(" << varname << "), max(" << varname << "), avg(" << varname << "), count(" << varname << ")"
+      << " FROM " << table << " WHERE date > '" << mintime.toString()
+      << "' and date < '" << maxtime.toString() << "'"
+      << " GROUP BY bucket HAVING count(" << varname << ") > 0 ORDER BY bucket ASC";
+#ifdef VERBOSE
+  std::cout << "Command: " << cmd.str() << std::endl;
+#endif
+  odbc::Statement* query = con->createStatement();
+  odbc::ResultSet* rs = nullptr;
+  try
+  {
+    rs = query->executeQuery(cmd.str());
+  }
+  catch (odbc::SQLException& e)
+  {
+    std::cout << "Exception caught, probably your variable "
+              << varname << " or the table " << table
+              << " does not exist" << std::endl;
+    std::cout << "Message: " << e.getMessage() << std::endl;
+    delete query;
+    return -3;
+  }
+  while (rs->next())
+  {
+    bucket.push_back(begin + rs->getLong(1) * width);
+    varmin.push_back(rs->getFloat(2));
+    varmax.push_back(rs->getFloat(3));
+    varmean.push_back(rs->getFloat(4));
+    count.push_back(rs->getInt(5));
+  }
+  delete rs;
+  delete query;
+  if (bucket.empty())
+  {
+    return DBNOENTRIES;
+  }
+  return 0;
+}
+
+bool OnlMonDBodbc::Connected()
+{
+  return (con != nullptr);
+}
+
+int OnlMonDBodbc::UpdateInterval()
+{
+  return MINUTESINTERVAL * 60;
+}
+
 int OnlMonDBodbc::GetConnection()
 {
   if (con)
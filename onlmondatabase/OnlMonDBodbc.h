@@ -27,6 +27,16 @@ class OnlMonDBodbc : public OnlMonBase
   void identify() const;
   int AddRow(const time_t ticks, const int runnumber, const std::map<const std::string, OnlMonDBVar *> &varmap);
   int GetVar(const time_t begin, const time_t end, const std::string &varname, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<float> &var, std::vector<float> &varerr);
+  // all varnames with a single query, var[i] and varerr[i] are aligned with timestp.
+  // Values which are not set are NaN, rows without any set value are skipped
+  int GetVars(const time_t begin, const time_t end, const std::vector<std::string> &varnames, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<std::vector<float>> &var, std::vector<std::vector<float>> &varerr);
+  // varname in nbuckets equal time bins between begin and end, aggregated by the db.
+  // Only non empty buckets are returned, bucket is the start time of each bucket
+  int GetVarTrend(const time_t begin, const time_t end, const std::string &varname, const unsigned int nbuckets, std::vector<time_t> &bucket, std::vector<float> &varmin, std::vector<float> &varmax, std::vector<float> &varmean, std::vector<int> &count);
+  // the connection is shared by all tables and kept open until the last one is deleted
+  static bool Connected();
+  // AddRow updates the row within this many seconds of its time stamp instead of adding one
+  static int UpdateInterval();
 
  private:
   void Dump(odbc::ResultSet *rs) const;
@@ -0,0 +1,238 @@
+// GetVar with the row cache against a stand-in table in memory, every answer
+// has to be the one of the uncached query
+
+#include "OnlMonDB.h"
+#include "OnlMonDBReturnCodes.h"
+
+#include <onlmon/OnlMonTest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+  using OnlMonTest::Check;
+
+  class StandInDB : public OnlMonDB
+  {
+   public:
+    StandInDB()
+      : OnlMonDB("standin")
+    {
+    }
+    // AddRow of the real db: a row within the update interval is overwritten
+    void AddRow(const time_t ticks, const int run, const std::string &varname, const float value)
+    {
+      auto &rows = table[varname];
+      for (auto &row : rows)
+      {
+        if (std::abs(row.first - ticks) < 4 * 60)
+        {
+          row.second = std::make_tuple(run, value, value / 10);
+          return;
+        }
+      }
+      rows[ticks] = std::make_tuple(run, value, value / 10);
+    }
+    int Direct(const time_t begin, const time_t end, const std::string &varname, std::vector<time_t> &timestp, std::vector<float> &var)
+    {
+      std::vector<int> runnumber;
+      std::vector<float> varerr;
+      return Select(begin, end, varname, timestp, runnumber, var, varerr);
+    }
+    int DirectVars(const time_t begin, const time_t end, const std::vector<std::string> &varnames, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<std::vector<float>> &var, std::vector<std::vector<float>> &varerr)
+    {
+      return QueryVars(begin, end, varnames, timestp, runnumber, var, varerr);
+    }
+    int nqueries = 0;
+    time_t lastbegin = 0;
+
+   protected:
+    int QueryVar(const time_t begin, const time_t end, const std::string &varname, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<float> &var, std::vector<float> &varerr) override
+    {
+      nqueries++;
+      lastbegin = begin;
+      return Select(begin, end, varname, timestp, runnumber, var, varerr);
+    }
+
+    int QueryVars(const time_t begin, const time_t end, const std::vector<std::string> &varnames, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<std::vector<float>> &var, std::vector<std::vector<float>> &varerr) override
+    {
+      // a row is a time stamp, rows without any of the variables are skipped
+      std::map<time_t, int> rows;
+      for (auto &varname : varnames)
+      {
+        for (auto &row : table[varname])
+        {
+          if (row.first > begin && row.first < end)
+          {
+            rows[row.first] = std::get<0>(row.second);
+          }
+        }
+      }
+      timestp.clear();
+      runnumber.clear();
+      var.assign(varnames.size(), std::vector<float>());
+      varerr.assign(varnames.size(), std::vector<float>());
+      for (auto &row : rows)
+      {
+        timestp.push_back(row.first);
+        runnumber.push_back(row.second);
+        for (unsigned int i = 0; i < varnames.size(); i++)
+        {
+          auto iter = table[varnames[i]].find(row.first);
+          var[i].push_back((iter != table[varnames[i]].end()) ? std::get<1>(iter->second) : std::numeric_limits<float>::quiet_NaN());
+          varerr[i].push_back((iter != table[varnames[i]].end()) ? std::get<2>(iter->second) : std::numeric_limits<float>::quiet_NaN());
+        }
+      }
+      return (timestp.empty()) ? DBNOENTRIES : DBOKAY;
+    }
+
+   private:
+    int Select(const time_t begin, const time_t end, const std::string &varname, std::vector<time_t> &timestp, std::vector<int> &runnumber, std::vector<float> &var, std::vector<float> &varerr)
+    {
+      timestp.clear();
+      runnumber.clear();
+      var.clear();
+      varerr.clear();
+      for (auto &row : table[varname])
+      {
+        if (row.first > begin && row.first < end)
+        {
+          timestp.push_back(row.first);
+          runnumber.push_back(std::get<0>(row.second));
+          var.push_back(std::get<1>(row.second));
+          varerr.push_back(std::get<2>(row.second));
+        }
+      }
+      return (timestp.empty()) ? DBNOENTRIES : DBOKAY;
+    }
+
+    std::map<std::string, std::map<time_t, std::tuple<int, float, float>>> table;
+  };
+
+  // cached and uncached answers are the same
+  bool Same(StandInDB &db, const time_t begin, const time_t end, const std::string &varname)
+  {
+    std::vector<time_t> timestp, directtimestp;
+    std::vector<int> runnumber;
+    std::vector<float> var, varerr, directvar;
+    int iret = db.GetVar(begin, end, varname, timestp, runnumber, var, varerr);
+    int directiret = db.Direct(begin, end, varname, directtimestp, directvar);
+    return iret == directiret && timestp == directtimestp && var == directvar;
+  }
+
+  // NaN != NaN, the unset values have to be at the same places
+  bool SameValues(const std::vector<std::vector<float>> &var1, const std::vector<std::vector<float>> &var2)
+  {
+    if (var1.size() != var2.size())
+    {
+      return false;
+    }
+    for (unsigned int i = 0; i < var1.size(); i++)
+    {
+      if (var1[i].size() != var2[i].size())
+      {
+        return false;
+      }
+      for (unsigned int j = 0; j < var1[i].size(); j++)
+      {
+        if (std::isnan(var1[i][j]) != std::isnan(var2[i][j]) || (!std::isnan(var1[i][j]) && var1[i][j] != var2[i][j]))
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // GetVars from the per variable caches is the single query
+  bool SameVars(StandInDB &db, const time_t begin, const time_t end, const std::vector<std::string> &varnames)
+  {
+    std::vector<time_t> timestp, directtimestp;
+    std::vector<int> runnumber, directrunnumber;
+    std::vector<std::vector<float>> var, varerr, directvar, directvarerr;
+    int iret = db.GetVars(begin, end, varnames, timestp, runnumber, var, varerr);
+    int directiret = db.DirectVars(begin, end, varnames, directtimestp, directrunnumber, directvar, directvarerr);
+    return iret == directiret && timestp == directtimestp && runnumber == directrunnumber &&
+           SameValues(var, directvar) && SameValues(varerr, directvarerr);
+  }
+}  // namespace
+
+int main()
+{
+  const time_t t0 = 1700000000;
+  const int interval = 10 * 60;
+  StandInDB db;
+  db.UseCache(1);
+  db.CacheLatency(900);
+  int run = 100;
+  for (int i = 0; i < 100; i++)
+  {
+    db.AddRow(t0 + i * interval, run, "var1", i);
+  }
+  time_t now = t0 + 100 * interval;
+  Check(Same(db, t0 - 1000, now, "var1"), "first read");
+
+  for (int i = 100; i < 110; i++)
+  {
+    db.AddRow(t0 + i * interval, run, "var1", i);
+  }
+  now = t0 + 110 * interval;
+  Check(Same(db, t0 - 1000, now, "var1"), "new rows are added");
+  Check(db.lastbegin == t0 + 100 * interval - 900, "only the trailing window is read again");
+
+  // a lagging server commits a row with an event time before the last read
+  db.AddRow(now - interval / 2, run, "var1", 1000.);
+  // and updates the row it committed last
+  db.AddRow(now - interval + 60, run, "var1", 2000.);
+  Check(Same(db, t0 - 1000, now + interval, "var1"), "late and updated rows in the trailing window are seen");
+
+  // late rows older than the window come in with the next run
+  db.AddRow(t0 + 50 * interval + interval / 2, run, "var1", 3000.);
+  run++;
+  db.AddRow(now + 2 * interval, run, "var1", 4000.);
+  Check(Same(db, t0 - 1000, now + 3 * interval, "var1"), "a new run reads everything again");
+  int nqueries = db.nqueries;
+  Check(Same(db, t0 - 1000, now + 3 * interval, "var1") && db.nqueries == nqueries + 1, "one query per call afterwards");
+
+  Check(Same(db, t0 + 20 * interval, now + 3 * interval, "var1"), "moving window start");
+  Check(Same(db, t0, now + 3 * interval, "var1"), "earlier window start reads again");
+  Check(Same(db, t0, now, "var1"), "earlier window end reads again");
+  Check(Same(db, t0, now + 3 * interval, "nosuchvar"), "unknown variable");
+
+  // the row limit covers all variables, the least recently used goes first
+  for (int i = 0; i < 100; i++)
+  {
+    db.AddRow(t0 + i * interval, run, "var2", -i);
+    db.AddRow(t0 + i * interval, run, "var3", i * i);
+  }
+  db.CacheMaxRows(150);
+  Check(Same(db, t0 - 1000, now, "var2") && Same(db, t0 - 1000, now, "var3"), "reads with a row limit");
+  Check(db.CachedRows() <= 150, "row limit of all variables is kept");
+  Check(Same(db, t0 - 1000, now, "var2"), "reads after dropping rows");
+  db.CacheMaxRows(50);
+  Check(Same(db, t0 - 1000, now, "var3") && db.CachedRows() <= 50, "a single variable above the limit keeps its newest rows");
+
+  // var4 is only set in every other row of var2
+  db.CacheMaxRows(1000000);
+  for (int i = 0; i < 100; i += 2)
+  {
+    db.AddRow(t0 + i * interval, run, "var4", i / 2);
+  }
+  db.AddRow(t0 + 200 * interval, run, "var4", 17);
+  Check(SameVars(db, t0 - 1000, now + 200 * interval, {"var2", "var4"}), "several variables from the cache");
+  Check(SameVars(db, t0 + 30 * interval, now + 200 * interval, {"var4", "var2", "nosuchvar"}), "several variables with an unknown one");
+  Check(SameVars(db, t0 + 300 * interval, now + 300 * interval, {"var2", "var4"}), "several variables without rows");
+
+  db.UseCache(0);
+  Check(Same(db, t0 - 1000, now, "var1"), "uncached read");
+
+  return (OnlMonTest::Summary()) ? 1 : 0;
+}
@@ -7,6 +7,10 @@ namespace OnlMonDefs
   const unsigned int MONIPORT = 9081;
   const unsigned int NUMMONIPORT = 5;
   const unsigned int MSGLEN = 256;
+  // histograms with more cells are sent compressed, as their filled bins
+  // only (OnlMonSparse.h) if less than 1/SPARSEFRACTION of the cells are filled
+  const int COMPRESSNCELLS = 100000;
+  const int SPARSEFRACTION = 4;
 }
 
 #endif
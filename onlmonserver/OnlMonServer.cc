@@ -7,6 +7,8 @@
 
 #include <Event/msg_profile.h>  // for MSG_SEV_ERROR, MSG_SEV...
 
+#include <TAxis.h>
+#include <TClass.h>
 #include <TFile.h>
 #include <TH1.h>
 #include <TROOT.h>
@@ -22,6 +24,7 @@
 #include <sys/utsname.h>
 #include <unistd.h>   // for sleep
 #include <algorithm>  // for max
+#include <cmath>
 #include <cstdio>     // for printf
 #include <cstdlib>
 #include <cstring>  // for strcmp
@@ -183,6 +186,7 @@ void OnlMonServer::registerHisto(const std::string &monitorname, const std::stri
     {
       delete histoiter->second;
       histoiter->second = h1d;
+      HistoModified(monitorname, hname);
     }
     else
     {
@@ -379,6 +383,195 @@ TH1 *OnlMonServer::getCommonHisto(const std::string &hname) const
   return nullptr;
 }
 
+unsigned int OnlMonServer::HistoVersion(const std::string &subsys, const std::string &hname) const
+{
+  auto moniiter = MonitorHistoSet.find(subsys);
+  if (moniiter == MonitorHistoSet.end() || moniiter->second.find(hname) == moniiter->second.end())
+  {
+    return 0;
+  }
+  unsigned int version = 1;
+  auto changeiter = MonitorChanges.find(subsys);
+  if (changeiter != MonitorChanges.end())
+  {
+    version += changeiter->second;
+  }
+  auto histochangeiter = HistoChanges.find(subsys);
+  if (histochangeiter != HistoChanges.end())
+  {
+    auto hiter = histochangeiter->second.find(hname);
+    if (hiter != histochangeiter->second.end())
+    {
+      version += hiter->second;
+    }
+  }
+  return version;
+}
+
+void OnlMonServer::HistoModified(const std::string &monitorname)
+{
+  MonitorChanges[monitorname]++;
+  return;
+}
+
+void OnlMonServer::HistoModified(const std::string &monitorname, const std::string &hname)
+{
+  HistoChanges[monitorname][hname]++;
+  return;
+}
+
+TH1 *OnlMonServer::getHistoSlice(const std::string &subsys, const std::string &hname, const int xlo, const int xhi,
+                                 const int ylo, const int yhi, const int zlo, const int zhi) const
+{
+  int lo[3] = {xlo, ylo, zlo};
+  int hi[3] = {xhi, yhi, zhi};
+  int group[3] = {1, 1, 1};
+  return CopyBins(subsys, hname, lo, hi, group);
+}
+
+TH1 *OnlMonServer::getHistoRebinned(const std::string &subsys, const std::string &hname, const int fx, const int fy, const int fz) const
+{
+  int lo[3] = {1, 1, 1};
+  int hi[3] = {0, 0, 0};
+  int group[3] = {fx, fy, fz};
+  return CopyBins(subsys, hname, lo, hi, group);
+}
+
+TH1 *OnlMonServer::CopyBins(const std::string &subsys, const std::string &hname, int lo[3], int hi[3], int group[3]) const
+{
+  TH1 *histo = getHisto(subsys, hname);
+  if (!histo)
+  {
+    return nullptr;
+  }
+  // their bins are more than a content and an error
+  if (histo->InheritsFrom("TProfile") || histo->InheritsFrom("TProfile2D") ||
+      histo->InheritsFrom("TProfile3D") || histo->InheritsFrom("TH2Poly"))
+  {
+    std::cout << __PRETTY_FUNCTION__ << " cannot copy bins of " << histo->ClassName() << " " << hname << std::endl;
+    return nullptr;
+  }
+  int dim = histo->GetDimension();
+  TAxis *axis[3] = {histo->GetXaxis(), histo->GetYaxis(), histo->GetZaxis()};
+  std::vector<double> edges[3];
+  int nbins[3] = {1, 1, 1};
+  for (int i = 0; i < 3; i++)
+  {
+    if (i >= dim)
+    {
+      lo[i] = 1;
+      hi[i] = 1;
+      group[i] = 1;
+      continue;
+    }
+    if (hi[i] < lo[i])
+    {
+      lo[i] = 1;
+      hi[i] = axis[i]->GetNbins();
+    }
+    lo[i] = std::max(lo[i], 1);
+    hi[i] = std::min(hi[i], axis[i]->GetNbins());
+    if (hi[i] < lo[i])
+    {
+      if (Verbosity() > 0)
+      {
+        std::cout << __PRETTY_FUNCTION__ << " empty bin range for axis " << i << " of " << hname << std::endl;
+      }
+      return nullptr;
+    }
+    group[i] = std::min(std::max(group[i], 1), hi[i] - lo[i] + 1);
+    // the last bin is narrower if group does not divide the number of bins
+    for (int ibin = lo[i]; ibin <= hi[i]; ibin += group[i])
+    {
+      edges[i].push_back(axis[i]->GetBinLowEdge(ibin));
+    }
+    edges[i].push_back(axis[i]->GetBinUpEdge(hi[i]));
+    nbins[i] = edges[i].size() - 1;
+  }
+  // only the selected bins are touched, the full histogram is not copied
+  TH1 *copy = static_cast<TH1 *>(histo->IsA()->New());
+  copy->SetName(histo->GetName());
+  copy->SetTitle(histo->GetTitle());
+  switch (dim)
+  {
+  case 1:
+    copy->SetBins(nbins[0], edges[0].data());
+    break;
+  case 2:
+    copy->SetBins(nbins[0], edges[0].data(), nbins[1], edges[1].data());
+    break;
+  default:
+    copy->SetBins(nbins[0], edges[0].data(), nbins[1], edges[1].data(), nbins[2], edges[2].data());
+    break;
+  }
+  TAxis *copyaxis[3] = {copy->GetXaxis(), copy->GetYaxis(), copy->GetZaxis()};
+  for (int i = 0; i < dim; i++)
+  {
+    copyaxis[i]->SetTitle(axis[i]->GetTitle());
+    if (axis[i]->GetLabels() && group[i] == 1)
+    {
+      for (int ibin = lo[i]; ibin <= hi[i]; ibin++)
+      {
+        copyaxis[i]->SetBinLabel(ibin - lo[i] + 1, axis[i]->GetBinLabel(ibin));
+      }
+    }
+  }
+  bool errors = (histo->GetSumw2N() > 0);
+  std::vector<double> err2;
+  if (errors)
+  {
+    copy->Sumw2();
+    err2.resize(copy->GetNcells(), 0.);
+  }
+  for (int iz = lo[2]; iz <= hi[2]; iz++)
+  {
+    for (int iy = lo[1]; iy <= hi[1]; iy++)
+    {
+      for (int ix = lo[0]; ix <= hi[0]; ix++)
+      {
+        int bin = histo->GetBin(ix, iy, iz);
+        int copybin = copy->GetBin((ix - lo[0]) / group[0] + 1, (iy - lo[1]) / group[1] + 1, (iz - lo[2]) / group[2] + 1);
+        copy->AddBinContent(copybin, histo->GetBinContent(bin));
+        if (errors)
+        {
+          err2[copybin] += histo->GetBinError(bin) * histo->GetBinError(bin);
+        }
+      }
+    }
+  }
+  for (unsigned int ibin = 0; ibin < err2.size(); ibin++)
+  {
+    copy->SetBinError(ibin, std::sqrt(err2[ibin]));
+  }
+  // entries cannot be recovered from the bins (weights), a cut out range
+  // gets the share of the entries its bins have of the total content
+  bool fullrange = true;
+  for (int i = 0; i < dim; i++)
+  {
+    fullrange = fullrange && lo[i] == 1 && hi[i] == axis[i]->GetNbins();
+  }
+  double entries = histo->GetEntries();
+  if (!fullrange)
+  {
+    double total = histo->GetSumOfWeights();
+    double fraction = 1.;
+    if (total != 0)
+    {
+      fraction = copy->GetSumOfWeights() / total;
+    }
+    else
+    {
+      for (int i = 0; i < dim; i++)
+      {
+        fraction *= static_cast<double>(hi[i] - lo[i] + 1) / axis[i]->GetNbins();
+      }
+    }
+    entries *= std::min(std::max(fraction, 0.), 1.);
+  }
+  copy->SetEntries(entries);
+  return copy;
+}
+
 int OnlMonServer::run_empty(const int nevents)
 {
   int iret = 0;
@@ -401,6 +594,7 @@ int OnlMonServer::process_event(Event *evt)
   for (iter = MonitorList.begin(); iter != MonitorList.end(); ++iter)
   {
     i += (*iter)->process_event_common(evt);
+    HistoModified((*iter)->Name());
   }
   for (iter = MonitorList.begin(); iter != MonitorList.end(); ++iter)
   {
@@ -421,6 +615,7 @@ int OnlMonServer::Reset()
   std::map<const std::string, TH1 *>::const_iterator hiter;
   for (auto &moniiter : MonitorHistoSet)
   {
+    HistoModified(moniiter.first);
      for (auto &histiter : moniiter.second)
     {
       histiter.second->Reset();
@@ -456,6 +651,7 @@ int OnlMonServer::BeginRun(const int runno)
   {
     (*iter)->BeginRunCommon(runno, this);
     i += (*iter)->BeginRun(runno);
+    HistoModified((*iter)->Name());
   }
   return i;
 }
@@ -467,6 +663,7 @@ int OnlMonServer::EndRun(const int runno)
   for (iter = MonitorList.begin(); iter != MonitorList.end(); ++iter)
   {
     i += (*iter)->EndRun(runno);
+    HistoModified((*iter)->Name());
   }
   return i;
 }
@@ -38,6 +38,24 @@ class OnlMonServer : public OnlMonBase
   TH1 *getCommonHisto(const std::string &hname) const;
   TH1 *getHisto(const unsigned int ihisto) const;
   const std::string getHistoName(const unsigned int ihisto) const;
+  // modification counter of a histogram, 0 means unknown histogram. It advances
+  // with every event, Reset, BeginRun and EndRun of its monitor (which may or may
+  // not have filled it) and when the histogram is replaced or marked by HistoModified
+  unsigned int HistoVersion(const std::string &subsys, const std::string &hname) const;
+  // for histograms changed outside of the event loop of their monitor
+  void HistoModified(const std::string &monitorname);
+  void HistoModified(const std::string &monitorname, const std::string &hname);
+  // new histogram (owned by the caller) with the bins xlo..xhi, ylo..yhi, zlo..zhi
+  // of a registered histogram, hi < lo selects the full axis. Under- and overflow
+  // bins are dropped, the entries are the share of the cut out bins of the total
+  // content (all entries for the full range). Returns nullptr for unknown
+  // histograms, empty ranges and histograms which cannot be cut (profiles, TH2Poly)
+  TH1 *getHistoSlice(const std::string &subsys, const std::string &hname, const int xlo, const int xhi,
+                     const int ylo = 1, const int yhi = 0, const int zlo = 1, const int zhi = 0) const;
+  // new histogram (owned by the caller) with fx x fy x fz bins of a registered
+  // histogram combined into one, for displays which cannot show all bins anyway.
+  // It has the entries of the histogram, under- and overflow bins are dropped
+  TH1 *getHistoRebinned(const std::string &subsys, const std::string &hname, const int fx, const int fy = 1, const int fz = 1) const;
   unsigned int nHistos() const { return CommonHistoMap.size(); }
   int RunNumber() const { return runnumber; }
   void RunNumber(const int irun);
@@ -104,6 +122,8 @@ class OnlMonServer : public OnlMonBase
   int send_message(const int severity, const std::string &err_message, const int msgtype) const;
   int CacheRunDB(const int runno);
   void registerHisto(const std::string &hname, TH1 *h1d, const int replace = 0);
+  // copy the bins lo..hi of each axis, group bins combined into one
+  TH1 *CopyBins(const std::string &subsys, const std::string &hname, int lo[3], int hi[3], int group[3]) const;
 
   static OnlMonServer *__instance;
   int runnumber = -1;
@@ -128,6 +148,9 @@ class OnlMonServer : public OnlMonBase
   std::set<unsigned int> activepackets;
   std::map<std::string, MessageSystem *> MsgSystem;
   std::map<std::string, std::map<std::string, TH1 *>> MonitorHistoSet;
+  // the version of a histogram is the sum of the changes of its monitor and its own
+  std::map<std::string, unsigned int> MonitorChanges;
+  std::map<std::string, std::map<std::string, unsigned int>> HistoChanges;
   pthread_mutex_t mutex;
   pthread_t serverthreadid = 0;
 };
@@ -0,0 +1,85 @@
+#ifndef ONLMONSERVER_ONLMONSPARSE_H
+#define ONLMONSERVER_ONLMONSPARSE_H
+
+// large and mostly empty histograms (e.g. the INTT hit map) go over the wire
+// as a shell without bins followed by the non zero bins, the client
+// materializes the bins again after reading the shell. The server writes
+// with Write, the client calls Read after every ReadObjectAny of a histogram
+
+#include "OnlMonDefs.h"
+
+#include <TArray.h>
+#include <TH1.h>
+#include <TMessage.h>
+
+#include <vector>
+
+namespace OnlMonSparse
+{
+  // histograms with errors or bin entries (profiles) are always sent in full
+  inline bool Sparse(const TH1 *histo, const int nfilled)
+  {
+    return histo->GetNcells() > OnlMonDefs::COMPRESSNCELLS && histo->GetSumw2N() == 0 &&
+           !histo->InheritsFrom("TProfile") && !histo->InheritsFrom("TProfile2D") && !histo->InheritsFrom("TProfile3D") &&
+           nfilled < histo->GetNcells() / OnlMonDefs::SPARSEFRACTION;
+  }
+
+  inline void Write(TMessage &outgoing, const TH1 *histo)
+  {
+    const TArray *cells = dynamic_cast<const TArray *>(histo);
+    std::vector<int> bins;
+    std::vector<double> contents;
+    if (cells && histo->GetNcells() > OnlMonDefs::COMPRESSNCELLS)
+    {
+      for (int bin = 0; bin < cells->GetSize(); bin++)
+      {
+        double content = cells->GetAt(bin);
+        if (content != 0)
+        {
+          bins.push_back(bin);
+          contents.push_back(content);
+        }
+      }
+    }
+    if (!cells || !Sparse(histo, bins.size()))
+    {
+      outgoing.WriteObject(histo);
+      return;
+    }
+    // the shell keeps name, axes, attributes and statistics
+    TH1 *shell = static_cast<TH1 *>(histo->Clone());
+    dynamic_cast<TArray *>(shell)->Set(0);
+    outgoing.WriteObject(shell);
+    delete shell;
+    int nfilled = bins.size();
+    outgoing.WriteInt(nfilled);
+    outgoing.WriteFastArray(bins.data(), nfilled);
+    outgoing.WriteFastArray(contents.data(), nfilled);
+    return;
+  }
+
+  // histograms which were sent in full are left alone
+  inline void Read(TMessage *mess, TH1 *histo)
+  {
+    TArray *cells = dynamic_cast<TArray *>(histo);
+    if (!cells || cells->GetSize() > 0 || histo->GetNcells() == 0)
+    {
+      return;
+    }
+    int nfilled = 0;
+    mess->ReadInt(nfilled);
+    std::vector<int> bins(nfilled);
+    std::vector<double> contents(nfilled);
+    mess->ReadFastArray(bins.data(), nfilled);
+    mess->ReadFastArray(contents.data(), nfilled);
+    // SetAt does not touch the entries and statistics streamed with the shell
+    cells->Set(histo->GetNcells());
+    for (int i = 0; i < nfilled; i++)
+    {
+      cells->SetAt(contents[i], bins[i]);
+    }
+    return;
+  }
+}  // namespace OnlMonSparse
+
+#endif /* ONLMONSERVER_ONLMONSPARSE_H */
@@ -0,0 +1,46 @@
+#ifndef ONLMONSERVER_ONLMONTEST_H
+#define ONLMONSERVER_ONLMONTEST_H
+
+// bookkeeping of the check programs (make check) and the test macros:
+// every Check prints PASS or FAIL, Summary prints the number of failed checks
+// which is what the macros exit with, the programs return 1 if any failed
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace OnlMonTest
+{
+  inline int &Failures()
+  {
+    static int nfail = 0;
+    return nfail;
+  }
+
+  inline void Check(const bool ok, const std::string &what)
+  {
+    std::cout << (ok ? "PASS " : "FAIL ") << what << std::endl;
+    if (!ok)
+    {
+      Failures()++;
+    }
+  }
+
+  inline int Summary()
+  {
+    std::cout << Failures() << " checks failed" << std::endl;
+    return Failures();
+  }
+
+  // wall clock seconds of a call, for the timings printed next to the checks
+  template <class F>
+  double Seconds(F &&f)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+}  // namespace OnlMonTest
+
+#endif /* ONLMONSERVER_ONLMONTEST_H */
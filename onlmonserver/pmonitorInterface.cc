@@ -7,6 +7,7 @@
 #include "OnlMon.h"
 #include "OnlMonDefs.h"
 #include "OnlMonServer.h"
+#include "OnlMonSparse.h"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -51,6 +52,9 @@ static void *server(void *);
 int ServerThread = 0;
 #endif
 
+static void write_histo(TMessage &outgoing, const TH1 *histo);
+static TH1 *histo_cutout(OnlMonServer *se, const std::string &args, const bool slicecmd);
+
 #ifdef ROOTTHREAD
 static void *server(void *);
 static TThread *ServerThread = nullptr;
@@ -423,8 +427,7 @@ void handleconnection(void *arg)
           TH1 *histo = Onlmonserver->getHisto(i);
           if (histo)
           {
-            outgoing.Reset();
-            outgoing.WriteObject(histo);
+            write_histo(outgoing, histo);
             s0->Send(outgoing);
             outgoing.Reset();
             s0->Recv(mess);
@@ -453,6 +456,104 @@ void handleconnection(void *arg)
         }
         s0->Send(answer.c_str());
       }
+      else if (str.find("VERSIONS ") == 0)
+      {
+        // send "hname version" for all histograms of this monitor
+        std::string moniname = str.substr(str.find(' ') + 1, str.size());
+        for (auto monitors = Onlmonserver->monibegin(); monitors != Onlmonserver->moniend(); ++monitors)
+        {
+          if (monitors->first != moniname)
+          {
+            continue;
+          }
+          for (auto &histos : monitors->second)
+          {
+            std::string histoversion = histos.first + ' ' + std::to_string(Onlmonserver->HistoVersion(monitors->first, histos.first));
+            if (Onlmonserver->Verbosity() > 2)
+            {
+              std::cout << " sending: \"" << histoversion << "\"" << std::endl;
+            }
+            s0->Send(histoversion.c_str());
+            int nbytes = s0->Recv(mess);
+            delete mess;
+            mess = nullptr;
+            if (nbytes <= 0)
+            {
+              std::ostringstream msg;
+
+              msg << "Problem receiving message: return code: " << nbytes;
+              send_message(MSG_SEV_ERROR, msg.str());
+              break;
+            }
+          }
+        }
+        s0->Send("Finished");
+      }
+      else if (str.find("VERSION ") == 0)
+      {
+        // VERSION <subsys> <hname>, answer is the version (0 if unknown)
+        std::string subsyshisto = str.substr(str.find(' ') + 1, str.size());
+        unsigned int pos_space = subsyshisto.find(' ');
+        unsigned int version = Onlmonserver->HistoVersion(subsyshisto.substr(0, pos_space), subsyshisto.substr(pos_space + 1, subsyshisto.size()));
+        s0->Send(std::to_string(version).c_str());
+      }
+      else if (str == "REBINLIST")
+      {
+        // the REBIN arguments <subsys> <hname> <fx> [<fy> [<fz>]] of many
+        // histograms over one connection, one answer per line until alldone
+        s0->Send("go");
+        while (true)
+        {
+          s0->Recv(mess);
+          if (!mess)
+          {
+            break;
+          }
+          char strmess[OnlMonDefs::MSGLEN];
+          mess->ReadString(strmess, OnlMonDefs::MSGLEN);
+          delete mess;
+          mess = nullptr;
+          if (std::string(strmess) == "alldone")
+          {
+            break;
+          }
+          TH1 *histo = histo_cutout(Onlmonserver, strmess, false);
+          if (histo)
+          {
+            write_histo(outgoing, histo);
+            s0->Send(outgoing);
+            outgoing.Reset();
+            delete histo;
+          }
+          else
+          {
+            s0->Send("UnknownHisto");
+          }
+        }
+        s0->Send("Finished");
+      }
+      else if (str.find("SLICE ") == 0 || str.find("REBIN ") == 0)
+      {
+        // SLICE <subsys> <hname> <xlo> <xhi> [<ylo> <yhi> [<zlo> <zhi>]]
+        // REBIN <subsys> <hname> <fx> [<fy> [<fz>]]
+        bool slicecmd = (str.find("SLICE ") == 0);
+        TH1 *histo = histo_cutout(Onlmonserver, str.substr(str.find(' ') + 1, str.size()), slicecmd);
+        if (histo)
+        {
+          write_histo(outgoing, histo);
+          s0->Send(outgoing);
+          outgoing.Reset();
+          delete histo;
+          s0->Recv(mess);
+          delete mess;
+          mess = nullptr;
+          s0->Send("Finished");
+        }
+        else
+        {
+          s0->Send("UnknownHisto");
+        }
+      }
       else if (str == "LISTMONITORS")
       {
         s0->Send("go");
@@ -497,8 +598,7 @@ void handleconnection(void *arg)
           TH1 *histo = Onlmonserver->getHisto(str1.substr(0, pos_space), str1.substr(pos_space + 1, str1.size()));
           if (histo)
           {
-            outgoing.Reset();
-            outgoing.WriteObject(histo);
+            write_histo(outgoing, histo);
             s0->Send(outgoing);
             outgoing.Reset();
           }
@@ -518,8 +618,7 @@ void handleconnection(void *arg)
         if (histo)
         {
           //		  const char *hisname = histo->GetName();
-          outgoing.Reset();
-          outgoing.WriteObject(histo);
+          write_histo(outgoing, histo);
           s0->Send(outgoing);
           outgoing.Reset();
           s0->Recv(mess);
@@ -560,3 +659,35 @@ int send_message(const int severity, const std::string &msg)
   delete Message;
   return 0;
 }
+
+void write_histo(TMessage &outgoing, const TH1 *histo)
+{
+  // large histograms are mostly empty, they are sent compressed and if few
+  // bins are filled as these bins only
+  outgoing.Reset();
+  outgoing.SetCompressionLevel((histo->GetNcells() > OnlMonDefs::COMPRESSNCELLS) ? 1 : 0);
+  OnlMonSparse::Write(outgoing, histo);
+  return;
+}
+
+TH1 *histo_cutout(OnlMonServer *se, const std::string &args, const bool slicecmd)
+{
+  // <subsys> <hname> <xlo> <xhi> [<ylo> <yhi> [<zlo> <zhi>]] for slices,
+  // <subsys> <hname> <fx> [<fy> [<fz>]] for rebinning
+  std::istringstream command(args);
+  std::string subsys;
+  std::string hname;
+  int bins[6] = {1, 0, 1, 0, 1, 0};
+  if (!slicecmd)
+  {
+    bins[1] = bins[2] = 1;
+  }
+  command >> subsys >> hname;
+  int bin;
+  for (int i = 0; i < 6 && command >> bin; i++)
+  {
+    bins[i] = bin;
+  }
+  return (slicecmd) ? se->getHistoSlice(subsys, hname, bins[0], bins[1], bins[2], bins[3], bins[4], bins[5])
+                    : se->getHistoRebinned(subsys, hname, bins[0], bins[1], bins[2]);
+}
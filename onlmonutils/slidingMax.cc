@@ -0,0 +1,63 @@
+#include "slidingMax.h"
+
+#include <algorithm>
+
+slidingMax::slidingMax(const int w)
+{
+  width = (w > 0) ? w : 1;
+  values = new int[width];
+  index = new long[width];
+}
+
+slidingMax::~slidingMax()
+{
+  delete[] values;
+  delete[] index;
+}
+
+int slidingMax::Add(const int value)
+{
+  if (width <= SCANWIDTH)
+  {
+    // the branches of the queue depend on the data, searching a few values
+    // is faster (testslidingmax prints both)
+    values[head] = value;
+    head = Wrap(head + 1);
+    nadded++;
+    int n = (nadded < width) ? nadded : width;
+    max = values[0];
+    for (int i = 1; i < n; i++)
+    {
+      max = std::max(max, values[i]);
+    }
+    return max;
+  }
+  // drop the first candidate once it leaves the window, this makes room
+  // for the new value in the ring buffer
+  if (ncand > 0 && index[head] <= nadded - width)
+  {
+    head = Wrap(head + 1);
+    ncand--;
+  }
+  // smaller values before this one can never be the maximum again
+  while (ncand > 0 && values[Wrap(head + ncand - 1)] <= value)
+  {
+    ncand--;
+  }
+  int tail = Wrap(head + ncand);
+  values[tail] = value;
+  index[tail] = nadded;
+  ncand++;
+  nadded++;
+  max = values[head];
+  return max;
+}
+
+int slidingMax::Reset()
+{
+  nadded = 0;
+  head = 0;
+  ncand = 0;
+  max = 0;
+  return 0;
+}
@@ -0,0 +1,72 @@
+#ifndef __SLIDINGMAX_H__
+#define __SLIDINGMAX_H__
+
+/**
+This is the sliding window maximum class.
+
+It keeps the maximum of the last "width" values which were added, e.g.
+to find the peaks of a waveform sample by sample. Instead of searching
+the whole window for every new value it keeps the values which can still
+become the maximum in descending order (a monotonic queue), so adding a
+value is O(1) on average and the maximum is always the first one. Windows
+of up to SCANWIDTH values are kept as they are and searched, for so few
+values that is faster than keeping the queue.
+
+The storage is allocated once in the constructor, call Reset() before
+the next waveform:
+
+\begin{verbatim}
+ slidingMax window(10);
+ for (int s = 0; s < nsamples; s++)
+ {
+   if (window.Add(adc[s]) == adc[s] && window.isFull())
+   {
+     // adc[s] is the maximum of the samples s-9 ... s
+   }
+ }
+ window.Reset();
+\end{verbatim}
+
+*/
+
+class slidingMax
+{
+ public:
+  explicit slidingMax(const int /*width*/);
+  ~slidingMax();
+
+  // delete copy ctor and assignment operator (cppcheck)
+  explicit slidingMax(const slidingMax &) = delete;
+  slidingMax &operator=(const slidingMax &) = delete;
+
+  /// Add a new value, returns the maximum of the last width values (including this one)
+  int Add(const int /*value*/);
+
+  /// the maximum of the last width values, only valid after the first Add()
+  int getMax() const { return max; }
+
+  /// true once width values were added since the last Reset()
+  bool isFull() const { return nadded >= width; }
+  int getWidth() const { return width; }
+
+  /// Reset empties the window
+  int Reset();
+
+ protected:
+  static const int SCANWIDTH = 16;
+
+  // position in the ring buffer, i is below 2*width. Cheaper than the
+  // modulo which is an integer division for every sample
+  int Wrap(const int i) const { return (i < width) ? i : i - width; }
+
+  int width;
+  long nadded = 0;
+  // ring buffer of the candidates for the maximum, descending values
+  // (all values of the window up to SCANWIDTH)
+  int *values;
+  long *index;
+  int head = 0;
+  int ncand = 0;
+  int max = 0;
+};
+#endif
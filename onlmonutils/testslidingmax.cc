@@ -0,0 +1,132 @@
+// slidingMax against the maximum searched over the whole window for random
+// waveforms, widths and resets in the middle of a waveform, and the time both
+// take for tpc sized waveforms
+
+#include "slidingMax.h"
+
+#include <onlmon/OnlMonTest.h>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  using OnlMonTest::Check;
+
+  // the maximum of the last width values, what TpcMon did before
+  int BruteForce(const std::vector<int> &values, const int width)
+  {
+    auto first = values.end() - std::min<long>(width, values.size());
+    return *std::max_element(first, values.end());
+  }
+
+  // sum of the maxima of all windows of all waveforms, the sum keeps the
+  // compiler from dropping the loops
+  long SlidingSum(const std::vector<std::vector<int>> &waveforms, const int width)
+  {
+    slidingMax window(width);
+    long sum = 0;
+    for (auto &adc : waveforms)
+    {
+      for (int value : adc)
+      {
+        sum += window.Add(value);
+      }
+      window.Reset();
+    }
+    return sum;
+  }
+
+  // the vector TpcMon used before: erase the oldest sample, append the new
+  // one and search all of them
+  long VectorWindowSum(const std::vector<std::vector<int>> &waveforms, const int width)
+  {
+    long sum = 0;
+    std::vector<int> window;
+    for (auto &adc : waveforms)
+    {
+      for (int value : adc)
+      {
+        if (static_cast<int>(window.size()) == width)
+        {
+          window.erase(window.begin());
+        }
+        window.push_back(value);
+        sum += *std::max_element(window.begin(), window.end());
+      }
+      window.clear();
+    }
+    return sum;
+  }
+}  // namespace
+
+int main()
+{
+  std::mt19937 rng(4711);
+  for (int width : {1, 2, 3, 10, 16, 17, 64})
+  {
+    slidingMax window(width);
+    bool same = true;
+    bool full = true;
+    for (int waveform = 0; waveform < 200; waveform++)
+    {
+      // narrow ranges give many equal values, wide ones long descending runs
+      std::uniform_int_distribution<int> adc(-5, (waveform % 2) ? 5 : 1023);
+      int nsamples = 1 + waveform % 150;
+      std::vector<int> added;
+      for (int s = 0; s < nsamples; s++)
+      {
+        int value = (waveform % 5 == 4) ? 1000 - s : adc(rng);
+        added.push_back(value);
+        int max = window.Add(value);
+        same = same && max == BruteForce(added, width) && window.getMax() == max;
+        full = full && window.isFull() == (static_cast<int>(added.size()) >= width);
+      }
+      window.Reset();
+    }
+    Check(same, "maximum of width " + std::to_string(width));
+    Check(full, "isFull of width " + std::to_string(width));
+  }
+
+  slidingMax single(0);
+  Check(single.getWidth() == 1 && single.Add(3) == 3 && single.Add(1) == 1, "width below 1 is 1");
+
+  // 3000 waveforms of 360 samples, about what ProcessWaveforms gets per chunk,
+  // TpcMon looks for peaks in windows of 10 samples
+  std::uniform_int_distribution<int> noise(75, 90);
+  std::vector<std::vector<int>> waveforms(3000, std::vector<int>(360));
+  for (auto &adc : waveforms)
+  {
+    std::generate(adc.begin(), adc.end(), [&]() { return noise(rng); });
+  }
+  for (int width : {10, 64})
+  {
+    long slidingsum = 0;
+    long vectorsum = 0;
+    auto sliding = [&]()
+    {
+      slidingsum = SlidingSum(waveforms, width);
+    };
+    auto vectorwindow = [&]()
+    {
+      vectorsum = VectorWindowSum(waveforms, width);
+    };
+    // the best of three, the first pass also warms the caches
+    double slidingseconds = OnlMonTest::Seconds(sliding);
+    double vectorseconds = OnlMonTest::Seconds(vectorwindow);
+    for (int i = 0; i < 2; i++)
+    {
+      slidingseconds = std::min(slidingseconds, OnlMonTest::Seconds(sliding));
+      vectorseconds = std::min(vectorseconds, OnlMonTest::Seconds(vectorwindow));
+    }
+    std::cout << "width " << width << ": " << slidingseconds << " s slidingMax, "
+              << vectorseconds << " s vector window" << std::endl;
+    Check(slidingsum == vectorsum, "same maxima as the vector window, width " + std::to_string(width));
+    Check(slidingseconds < vectorseconds, "slidingMax is faster than the vector window, width " + std::to_string(width));
+  }
+
+  return (OnlMonTest::Summary()) ? 1 : 0;
+}
@@ -35,8 +35,10 @@
 #include <TROOT.h>
 #include <TSeqCollection.h>      // for TSeqCollection
 #include <TString.h>             // for TString
+#include <TTimer.h>
 #include <WidgetMessageTypes.h>  // for GET_MSG, GET_SUBMSG, kCM_BUTTON
 
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>  // for strlen
@@ -74,6 +76,10 @@ PomsMainFrame::PomsMainFrame(const TGWindow* p, UInt_t w, UInt_t h)
 {
   // Constructor sets up window widgets
 
+  // histograms are prefetched in a background thread while looping, this
+  // has to happen before any other thread exists
+  ROOT::EnableThreadSafety();
+
   std::cout << POMS_VER << "PomsMainFrame constructor called..." << std::endl;
 
   // Find macro directory
@@ -113,6 +119,8 @@ PomsMainFrame::PomsMainFrame(const TGWindow* p, UInt_t w, UInt_t h)
   _menuWindow = new TGPopupMenu(gClient->GetRoot());
   _menuWindow->AddEntry("&Align Control Bar to Right", M_WINDOW_ALIGNRIGHT);
   _menuWindow->AddEntry("&Tile All", M_WINDOW_TILEALL);
+  _menuWindow->AddEntry("&Start Loop", M_WINDOW_STARTLOOP);
+  _menuWindow->AddEntry("Sto&p Loop", M_WINDOW_STOPLOOP);
   _menuWindow->Associate(this);
   _menuBar->AddPopup("&Window", _menuWindow, menuLayout);
   _menuBar->AddPopup("&DontpushThis", _menuFile, menuLayout);
@@ -132,6 +140,9 @@ void PomsMainFrame::SetMacroPath(const char* path)
 void PomsMainFrame::Draw()
 {
   OnlMonClient* cl = OnlMonClient::instance();
+  // canvases of drawers which implement HistoVersions are not redrawn
+  // while their histograms do not change
+  cl->DrawIncremental(1);
   // Let macro know what's happening
   std::cout << POMS_VER << "Attempting Build of PomsMainFrame..." << std::endl;
 
@@ -167,6 +178,7 @@ PomsMainFrame::~PomsMainFrame()
   delete _menuFile;
   delete _shutter;
   delete _menuWindow;
+  delete _loopTimer;
 
   //TODO:  Add code to clean up threads
 
@@ -218,6 +230,12 @@ Bool_t PomsMainFrame::ProcessMessage(Long_t msg, Long_t parm1, Long_t /* parm2 *
       case M_WINDOW_TILEALL:
         TileAllCanvases();
         break;
+      case M_WINDOW_STARTLOOP:
+        StartLoop(_loopDelay);
+        break;
+      case M_WINDOW_STOPLOOP:
+        StopLoop();
+        break;
 
       default:
         break;
@@ -421,6 +439,85 @@ void PomsMainFrame::TileAllCanvases()
   delete canvasList;
 }
 
+void PomsMainFrame::StartLoop(const int seconds)
+{
+  _loopActions.clear();
+  for (auto subSystem : _subSystemList)
+  {
+    for (auto action : *(subSystem->GetActions()))
+    {
+      if (action->IsDrawAction())
+      {
+        _loopActions.push_back(std::make_pair(subSystem, action));
+      }
+    }
+  }
+  if (_loopActions.empty())
+  {
+    std::cout << POMS_VER << "no draw actions to loop over" << std::endl;
+    return;
+  }
+  _loopDelay = (seconds > 0) ? seconds : 30;
+  _loopPosition = 0;
+  looping = 1;
+  // histograms are prefetched one page ahead, they are at most one delay old
+  OnlMonClient::instance()->PrefetchMaxAge(_loopDelay + 10);
+  if (!_loopTimer)
+  {
+    _loopTimer = new TTimer(this, 1000 * _loopDelay);
+  }
+  _loopTimer->SetTime(1000 * _loopDelay);
+  LoopDiLoop();
+  _loopTimer->TurnOn();
+}
+
+void PomsMainFrame::StopLoop()
+{
+  looping = 0;
+  if (_loopTimer)
+  {
+    _loopTimer->TurnOff();
+  }
+}
+
+Bool_t PomsMainFrame::HandleTimer(TTimer* timer)
+{
+  if (timer == _loopTimer)
+  {
+    LoopDiLoop();
+    return kTRUE;
+  }
+  return TGMainFrame::HandleTimer(timer);
+}
+
+void PomsMainFrame::LoopDiLoop()
+{
+  if (!looping || _loopActions.empty())
+  {
+    return;
+  }
+  if (_loopPosition >= _loopActions.size())
+  {
+    _loopPosition = 0;
+  }
+  SubSystem* subSystem = _loopActions[_loopPosition].first;
+  SubSystemAction* action = _loopActions[_loopPosition].second;
+  _loopPosition = (_loopPosition + 1) % _loopActions.size();
+
+  // the histograms of this page were fetched in the background while
+  // the previous one was shown, this only draws
+  auto start = std::chrono::steady_clock::now();
+  action->Execute();
+  std::chrono::duration<double> blocked = std::chrono::steady_clock::now() - start;
+  std::cout << POMS_VER << "Loop: " << subSystem->GetName() << " "
+            << action->GetDescription() << " took " << blocked.count() << " s" << std::endl;
+
+  // now fetch the next page (the same subsystem or the next one) in the background
+  SubSystem* next = _loopActions[_loopPosition].first;
+  next->Initialize();
+  OnlMonClient::instance()->PrefetchHistos(next->GetMonitors());
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // SubSystem Implementation                                                //
 /////////////////////////////////////////////////////////////////////////////
@@ -581,6 +678,25 @@ void SubSystem::AddDefaultActions()
   // AddAction(new SubSystemActionTileCanvases(this));
 }
 
+void SubSystem::Initialize()
+{
+  if (_initialized)  // Check to see if DrawInit() has been executed
+  {
+    return;
+  }
+  OnlMonClient* cl = OnlMonClient::instance();
+  std::set<std::string> before = cl->RegisteredMonitors();
+  gROOT->ProcessLine((_prefix + "DrawInit(1)").c_str());
+  for (auto& monitor : cl->RegisteredMonitors())
+  {
+    if (before.find(monitor) == before.end())
+    {
+      _monitors.insert(monitor);
+    }
+  }
+  _initialized = 1;
+}
+
 void SubSystem::TileCanvases()
 {
   PomsMainFrame* pmf = PomsMainFrame::Instance();
@@ -601,6 +717,7 @@ void SubSystem::CascadeCanvases()
 
 int SubSystemAction::_nextId = SUBSYSTEM_ACTION_ID_BEGIN;
 SubSystemActionMap SubSystemAction::_map;
+SubSystemAction* SubSystemAction::_lastDrawn = nullptr;
 
 SubSystemAction::SubSystemAction(SubSystem* parent)
   : _running(false)
@@ -650,20 +767,21 @@ SubSystemAction::SubSystemAction(SubSystem* parent, const char* cmd, const char*
 SubSystemAction::~SubSystemAction()
 {
   _map[_id] = nullptr;
+  if (_lastDrawn == this)
+  {
+    _lastDrawn = nullptr;
+  }
 }
 
-int SubSystemAction::Execute()
+void SubSystemAction::DeleteOtherCanvases()
 {
-  if (_running)
-    return 0;
-
-  _running = true;
-  if (!_parent->isInitialized())  // Check to see if DrawInit() has been executed
+  // drawing the same page again reuses its canvases, the client
+  // does not redraw them if their histograms did not change
+  if (_lastDrawn == this)
   {
-    gROOT->ProcessLine((_parent->GetPrefix() + "DrawInit(1)").c_str());
-    _parent->setInitialized(1);
+    return;
   }
-
+  _lastDrawn = this;
   TSeqCollection* allCanvases = gROOT->GetListOfCanvases();
   TCanvas* canvas = nullptr;
   while ((canvas = (TCanvas*) allCanvases->First()))
@@ -671,6 +789,17 @@ int SubSystemAction::Execute()
     std::cout << "Deleting Canvas " << canvas->GetName() << std::endl;
     delete canvas;
   }
+}
+
+int SubSystemAction::Execute()
+{
+  if (_running)
+    return 0;
+
+  _running = true;
+  _parent->Initialize();
+
+  DeleteOtherCanvases();
   gROOT->ProcessLine(_cmd.c_str());
   _running = false;
   return 0;
@@ -692,19 +821,9 @@ int SubSystemActionDraw::Execute()
 
   _running = true;
 
-  if (!_parent->isInitialized())  // Check to see if DrawInit() has been executed
-  {
-    gROOT->ProcessLine((_parent->GetPrefix() + "DrawInit(1)").c_str());
-    _parent->setInitialized(1);
-  }
+  _parent->Initialize();
 
-  TSeqCollection* allCanvases = gROOT->GetListOfCanvases();
-  TCanvas* canvas = nullptr;
-  while ((canvas = (TCanvas*) allCanvases->First()))
-  {
-    std::cout << "Deleting Canvas " << canvas->GetName() << std::endl;
-    delete canvas;
-  }
+  DeleteOtherCanvases();
   gROOT->ProcessLine((_parent->GetPrefix() + "Draw()").c_str());
   _running = false;
   return 0;
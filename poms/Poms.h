@@ -32,7 +32,10 @@
 
 #include <list>
 #include <map>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 /* forward declarations to speed up compilation */
 class TList;
@@ -41,6 +44,7 @@ class TGButton;
 class TGPopupMenu;
 class TGHotString;
 class TGWindow;
+class TTimer;
 
 #define POMS_VER "POMS Ver 1.0: "
 
@@ -50,6 +54,8 @@ enum EMessageID
   M_FILE_EXIT,
   M_WINDOW_ALIGNRIGHT,
   M_WINDOW_TILEALL,
+  M_WINDOW_STARTLOOP,
+  M_WINDOW_STOPLOOP,
   B_QUIT
 };
 
@@ -80,7 +86,13 @@ class PomsMainFrame : public TGMainFrame
   //Paths
   std::string _macroPath;
 
-  int looping;
+  int looping = 0;
+  // seconds each page is shown when looping
+  int _loopDelay = 30;
+  TTimer* _loopTimer = nullptr;
+  // pages the loop cycles through and the next one to show
+  std::vector<std::pair<SubSystem*, SubSystemAction*> > _loopActions;
+  unsigned int _loopPosition = 0;
   //Root Screen Properties
   /*** See constructor to change default values ***/
   UInt_t _rootWidth;
@@ -112,7 +124,9 @@ class PomsMainFrame : public TGMainFrame
  public:
   static PomsMainFrame* Instance();
   virtual ~PomsMainFrame();
+  void StartLoop(const int seconds = 30);
   void StopLoop();
+  virtual Bool_t HandleTimer(TTimer* timer);
 
   void SetMacroPath(const char* path);
   virtual void CloseWindow();
@@ -149,6 +163,8 @@ class SubSystem
   TList* _canvasList;
   SubSystemActionList _actions;
   int _initialized;
+  // monitors whose histograms were registered by DrawInit()
+  std::set<std::string> _monitors;
 
  public:
   SubSystem(const char* name, const char* prefix, int loadLibrary = 1);
@@ -166,12 +182,14 @@ class SubSystem
 
   void TileCanvases();
   void CascadeCanvases();
+  void Initialize();
 
   // Accessor Methods
   const std::string& GetName() { return _name; };
   const std::string& GetPrefix() { return _prefix; };
   SubSystemActionList* GetActions() { return &_actions; };
   int isInitialized() { return _initialized; }
+  const std::set<std::string>& GetMonitors() { return _monitors; }
   void setInitialized(const int i) { _initialized = i; }
 };
 
@@ -186,6 +204,8 @@ class SubSystemAction
   int _id;
   static int _nextId;
   static SubSystemActionMap _map;
+  // last action which drew, its canvases are kept if it draws again
+  static SubSystemAction* _lastDrawn;
 
   // Member Functions
   int NextId() { return _nextId++; };
@@ -201,6 +221,9 @@ class SubSystemAction
   virtual ~SubSystemAction();
 
   virtual int Execute();
+  void DeleteOtherCanvases();
+  // actions which only draw are shown by the loop
+  virtual bool IsDrawAction() { return !_cmd.empty(); }
 
   // Accessor Methods
   const std::string& GetCmd() { return _cmd; };
@@ -215,6 +238,7 @@ class SubSystemActionDraw : public SubSystemAction
   SubSystemActionDraw(SubSystem* parent);
   virtual ~SubSystemActionDraw(){};
   int Execute();
+  bool IsDrawAction() { return true; }
 };
 
 class SubSystemActionSavePlot : public SubSystemAction
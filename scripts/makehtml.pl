@@ -2,12 +2,49 @@
 
 use strict;
 use warnings;
+use File::Basename;
 
 sub findruns;
+sub readindex;
+sub waitforjobs;
+
+# number of root.exe html generators running in parallel, 1 runs them serially
+my $maxjobs = 1;
+if (defined $ENV{ONLMON_HTMLJOBS})
+{
+    $maxjobs = int($ENV{ONLMON_HTMLJOBS});
+}
+if ($maxjobs < 1)
+{
+    $maxjobs = 1;
+}
+my %runningjobs = ();
 
 my $histodir = sprintf("/sphenix/lustre01/sphnxpro/commissioning/online_monitoring/histograms");
 my @subsystems = ("BBCMON", "CEMCMON", "IHCALMON", "INTTMON", "LL1MON", "OHCALMON", "TPCMON", "TPOTMON");
 
+# update the index of the histogram files, this only opens new or
+# modified files. The runs and their files are taken from the index,
+# if this fails we fall back to listing the directories. The index goes
+# where OnlMonFileIndex::DefaultIndexFile() (and with it the client) looks
+my $indexdir = ".";
+if (defined $ENV{ONLMON_SAVEDIR})
+{
+    $indexdir = $ENV{ONLMON_SAVEDIR};
+}
+my $indexfile = sprintf("%s/onlmon_histo.index",$indexdir);
+my $indexcmd = sprintf("root.exe -q makeindex.C\\\(\\\"%s\\\",\\\"%s\\\"\\\)",$histodir,$indexfile);
+print "$indexcmd\n";
+my %indexfiles = ();
+if (system($indexcmd) == 0)
+{
+    %indexfiles = readindex($indexfile);
+}
+else
+{
+    print "index update failed, listing directories\n";
+}
+
 for my $subsys (@subsystems)
 {
     my %donehash = ();
@@ -23,7 +60,23 @@ for my $subsys (@subsystems)
 	close(F); 
     }
     my $subsysdir = sprintf("%s/%s",$histodir,$subsys);
-    my %todoruns = findruns($subsysdir,$subsys, \%donehash );
+    my %todoruns = ();
+    if (exists $indexfiles{$subsysdir})
+    {
+	for my $run (keys %{$indexfiles{$subsysdir}})
+	{
+# same selection of files as findruns
+	    @{$indexfiles{$subsysdir}{$run}} = grep { basename($_) =~ /$subsys/ } @{$indexfiles{$subsysdir}{$run}};
+	    if (@{$indexfiles{$subsysdir}{$run}} && ! exists $donehash{$run} && $run <= 80000)
+	    {
+		$todoruns{$run} = 1;
+	    }
+	}
+    }
+    else
+    {
+	%todoruns = findruns($subsysdir,$subsys, \%donehash );
+    }
 # store the last run and exclude from run done list so
 # we process it again in the next round, just in case we
 # transferred the histo files before the last one arrived
@@ -32,17 +85,46 @@ for my $subsys (@subsystems)
     {
 	if ($run < 80000) # tpot/intt creates large bad runnumbers
 	{
-	    my $listfile = sprintf("%s.list",$subsys);
-	    my $cmd = sprintf("ls -1 /sphenix/lustre01/sphnxpro/commissioning/online_monitoring/histograms/%s/Run_%d-* > %s.list",$subsys,$run,$subsys);
-	    print "$cmd\n";
-	    system($cmd);
-	    my $rootcmd = sprintf("root.exe -q makehtml.C\\\(\\\"%s.list\\\",\\\"%s\\\"\\\)",$subsys,$subsys);
+	    my $listfile = sprintf("%s_%d.list",$subsys,$run);
+	    if (exists $indexfiles{$subsysdir}{$run})
+	    {
+		open(L,">$listfile");
+		for my $file (sort @{$indexfiles{$subsysdir}{$run}})
+		{
+		    print L "$file\n";
+		}
+		close(L);
+	    }
+	    else
+	    {
+		my $cmd = sprintf("ls -1 /sphenix/lustre01/sphnxpro/commissioning/online_monitoring/histograms/%s/Run_%d-* > %s",$subsys,$run,$listfile);
+		print "$cmd\n";
+		system($cmd);
+	    }
+	    my $rootcmd = sprintf("root.exe -q makehtml.C\\\(\\\"%s\\\",\\\"%s\\\"\\\)",$listfile,$subsys);
 	    print "$rootcmd\n";
-	    system($rootcmd);
-	    print "handled $run for $subsys\n";
+	    waitforjobs($maxjobs-1);
+	    my $pid = fork();
+	    if (!defined $pid)
+	    {
+		print "fork failed, running $run for $subsys here\n";
+		system($rootcmd);
+		unlink($listfile);
+	    }
+	    elsif ($pid == 0)
+	    {
+		system($rootcmd);
+		unlink($listfile);
+		exit(0);
+	    }
+	    else
+	    {
+		$runningjobs{$pid} = $run;
+	    }
 	    $lastrun = $run; #process the last run again next ti
 	}
     }
+    waitforjobs(0);
     for my $run (sort { $a <=> $b } keys %todoruns)
     {
 	if ($lastrun == $run)
@@ -88,3 +170,53 @@ sub findruns
     return %todoruns;
 }
 
+# files of the histogram index written by makeindex.C as
+# $files{directory}{run} = [ file1, file2, ... ]
+sub readindex
+{
+    my $indexfile = shift;
+    my %files = ();
+    if (! open(I,"$indexfile"))
+    {
+	print "could not read $indexfile, listing directories\n";
+	return %files;
+    }
+    while (my $line = <I>)
+    {
+	chomp $line;
+	if ($line =~ /^#/ || $line =~ /^ /)
+	{
+	    next;
+	}
+	my ($run, $monitor, $size, $mtime, $nkeys, $file) = split(/ /,$line,6);
+	if (! defined $file)
+	{
+	    next;
+	}
+	my $dir = $file;
+	$dir =~ s/\/[^\/]*$//;
+	push(@{$files{$dir}{int($run)}}, $file);
+    }
+    close(I);
+    return %files;
+}
+
+# wait until no more than $maxrunning html generators are running
+sub waitforjobs
+{
+    my $maxrunning = shift;
+    while (keys %runningjobs > $maxrunning)
+    {
+	my $pid = waitpid(-1,0);
+	if ($pid <= 0)
+	{
+	    %runningjobs = ();
+	    last;
+	}
+	if (exists $runningjobs{$pid})
+	{
+	    print "handled run $runningjobs{$pid}\n";
+	    delete $runningjobs{$pid};
+	}
+    }
+}
@@ -13,6 +13,7 @@
 #include <TSystem.h>
 #include <TText.h>
 
+#include <cmath>
 #include <cstring>  // for memset
 #include <ctime>
 #include <fstream>
@@ -27,6 +28,8 @@ DaqMonDraw::DaqMonDraw(const std::string &name)
   TDatime T0(2003, 01, 01, 00, 00, 00);
   TimeOffsetTicks = T0.Convert();
   dbvars = new OnlMonDB(ThisName);
+  // the history goes back to 1970, only the newest rows are read again
+  dbvars->UseCache(1);
   return;
 }
 
@@ -276,16 +279,17 @@ int DaqMonDraw::DrawHistory(const std::string & /* what */)
 {
   int iret = 0;
   // you need to provide the following vectors
-  // which are filled from the db
-  std::vector<float> var;
-  std::vector<float> varerr;
+  // which are filled from the db, var[i] belongs to varnames[i]
+  std::vector<std::vector<float>> var;
+  std::vector<std::vector<float>> varerr;
   std::vector<time_t> timestamp;
   std::vector<int> runnumber;
-  std::string varname = "daqmondummy";
+  std::vector<std::string> varnames = {"daqmondummy", "daqmoncount"};
   // this sets the time range from whihc values should be returned
   time_t begin = 0;            // begin of time (1.1.1970)
   time_t end = time(nullptr);  // current time (right NOW)
-  iret = dbvars->GetVar(begin, end, varname, timestamp, runnumber, var, varerr);
+  // both variables with one query, values which were not set are NaN
+  iret = dbvars->GetVars(begin, end, varnames, timestamp, runnumber, var, varerr);
   if (iret)
   {
     std::cout << __PRETTY_FUNCTION__ << " Error in db access" << std::endl;
@@ -296,86 +300,43 @@ int DaqMonDraw::DrawHistory(const std::string & /* what */)
     MakeCanvas("DaqMon3");
   }
   // timestamps come sorted in ascending order
-  float *x = new float[var.size()];
-  float *y = new float[var.size()];
-  float *ex = new float[var.size()];
-  float *ey = new float[var.size()];
-  int n = var.size();
-  for (unsigned int i = 0; i < var.size(); i++)
+  float *x = new float[timestamp.size()];
+  float *y = new float[timestamp.size()];
+  float *ex = new float[timestamp.size()];
+  float *ey = new float[timestamp.size()];
+  for (unsigned int ivar = 0; ivar < varnames.size(); ivar++)
   {
-    //       std::cout << "timestamp: " << ctime(&timestamp[i])
-    // 	   << ", run: " << runnumber[i]
-    // 	   << ", var: " << var[i]
-    // 	   << ", varerr: " << varerr[i]
-    // 	   << std::endl;
-    x[i] = timestamp[i] - TimeOffsetTicks;
-    y[i] = var[i];
-    ex[i] = 0;
-    ey[i] = varerr[i];
-  }
-  Pad[4]->cd();
-  if (gr[0])
-  {
-    delete gr[0];
-  }
-  gr[0] = new TGraphErrors(n, x, y, ex, ey);
-  gr[0]->SetMarkerColor(4);
-  gr[0]->SetMarkerStyle(21);
-  gr[0]->Draw("ALP");
-  gr[0]->GetXaxis()->SetTimeDisplay(1);
-  gr[0]->GetXaxis()->SetLabelSize(0.03);
-  // the x axis labeling looks like crap
-  // please help me with this, the SetNdivisions
-  // don't do the trick
-  gr[0]->GetXaxis()->SetNdivisions(-1006);
-  gr[0]->GetXaxis()->SetTimeOffset(TimeOffsetTicks);
-  gr[0]->GetXaxis()->SetTimeFormat("%Y/%m/%d %H:%M");
-  delete[] x;
-  delete[] y;
-  delete[] ex;
-  delete[] ey;
-
-  varname = "daqmoncount";
-  iret = dbvars->GetVar(begin, end, varname, timestamp, runnumber, var, varerr);
-  if (iret)
-  {
-    std::cout << __PRETTY_FUNCTION__ << " Error in db access" << std::endl;
-    return iret;
-  }
-  x = new float[var.size()];
-  y = new float[var.size()];
-  ex = new float[var.size()];
-  ey = new float[var.size()];
-  n = var.size();
-  for (unsigned int i = 0; i < var.size(); i++)
-  {
-    //       std::cout << "timestamp: " << ctime(&timestamp[i])
-    // 	   << ", run: " << runnumber[i]
-    // 	   << ", var: " << var[i]
-    // 	   << ", varerr: " << varerr[i]
-    // 	   << std::endl;
-    x[i] = timestamp[i] - TimeOffsetTicks;
-    y[i] = var[i];
-    ex[i] = 0;
-    ey[i] = varerr[i];
-  }
-  Pad[5]->cd();
-  if (gr[1])
-  {
-    delete gr[1];
+    int n = 0;
+    for (unsigned int i = 0; i < timestamp.size(); i++)
+    {
+      if (std::isnan(var[ivar][i]))
+      {
+        continue;
+      }
+      x[n] = timestamp[i] - TimeOffsetTicks;
+      y[n] = var[ivar][i];
+      ex[n] = 0;
+      ey[n] = varerr[ivar][i];
+      n++;
+    }
+    Pad[4 + ivar]->cd();
+    if (gr[ivar])
+    {
+      delete gr[ivar];
+    }
+    gr[ivar] = new TGraphErrors(n, x, y, ex, ey);
+    gr[ivar]->SetMarkerColor(4);
+    gr[ivar]->SetMarkerStyle(21);
+    gr[ivar]->Draw("ALP");
+    gr[ivar]->GetXaxis()->SetTimeDisplay(1);
+    gr[ivar]->GetXaxis()->SetLabelSize(0.03);
+    // the x axis labeling looks like crap
+    // please help me with this, the SetNdivisions
+    // don't do the trick
+    gr[ivar]->GetXaxis()->SetNdivisions(-1006);
+    gr[ivar]->GetXaxis()->SetTimeOffset(TimeOffsetTicks);
+    gr[ivar]->GetXaxis()->SetTimeFormat("%Y/%m/%d %H:%M");
   }
-  gr[1] = new TGraphErrors(n, x, y, ex, ey);
-  gr[1]->SetMarkerColor(4);
-  gr[1]->SetMarkerStyle(21);
-  gr[1]->Draw("ALP");
-  gr[1]->GetXaxis()->SetTimeDisplay(1);
-  // TC[2]->Update();
-  //    h1->GetXaxis()->SetTimeDisplay(1);
-  //    h1->GetXaxis()->SetLabelSize(0.03);
-  gr[1]->GetXaxis()->SetLabelSize(0.03);
-  gr[1]->GetXaxis()->SetTimeOffset(TimeOffsetTicks);
-  gr[1]->GetXaxis()->SetTimeFormat("%Y/%m/%d %H:%M");
-  //    h1->Draw();
   delete[] x;
   delete[] y;
   delete[] ex;
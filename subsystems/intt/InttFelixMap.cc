@@ -1,6 +1,8 @@
 #include "InttFelixMap.h"
+#include "InttMonConstants.h"
 
-int INTT_Felix::FelixMap(int const& felix, int const& felix_channel, struct Ladder_s& ladder_struct)
+//the channel map, FelixMap reads it from a table built from this switch
+int INTT_Felix::FelixMapSwitch(int const& felix, int const& felix_channel, struct Ladder_s& ladder_struct)
 {
 	switch(felix)
 	{
@@ -644,3 +646,88 @@ int INTT_Felix::FelixMap(int const& felix, int const& felix_channel, struct Ladd
 	}
 	return EXIT_FAILURE;
 }
+
+namespace
+{
+	struct FelixMapEntry_s
+	{
+		struct INTT_Felix::Ladder_s ladder;
+		int status;
+	};
+
+	struct FelixMapTable_s
+	{
+		struct FelixMapEntry_s entry[INTT::FELIX][INTT::FELIX_CHANNEL];
+	};
+
+	struct FelixMapTable_s const& FelixMapTable()
+	{
+		//built once from the switch, so both always agree
+		static struct FelixMapTable_s const table = []()
+		{
+			struct FelixMapTable_s t;
+			for(int felix = 0; felix < INTT::FELIX; ++felix)
+			{
+				for(int felix_channel = 0; felix_channel < INTT::FELIX_CHANNEL; ++felix_channel)
+				{
+					struct FelixMapEntry_s& e = t.entry[felix][felix_channel];
+					e.ladder.barrel = -1;
+					e.ladder.layer = -1;
+					e.ladder.ladder = -1;
+					e.status = INTT_Felix::FelixMapSwitch(felix, felix_channel, e.ladder);
+				}
+			}
+			return t;
+		}();
+
+		return table;
+	}
+}
+
+int INTT_Felix::FelixMap(int const& felix, int const& felix_channel, struct Ladder_s& ladder_struct)
+{
+	//the switch keeps its behavior for anything outside of the table
+	if(felix < 0 || felix >= INTT::FELIX || felix_channel < 0 || felix_channel >= INTT::FELIX_CHANNEL)
+	{
+		return FelixMapSwitch(felix, felix_channel, ladder_struct);
+	}
+
+	struct FelixMapEntry_s const& e = FelixMapTable().entry[felix][felix_channel];
+	//channels without a ladder get whatever the switch writes for them
+	if(e.status != EXIT_SUCCESS)
+	{
+		return FelixMapSwitch(felix, felix_channel, ladder_struct);
+	}
+	ladder_struct = e.ladder;
+
+	return e.status;
+}
+
+int INTT_Felix::FelixMapBatch(int const& felix, int const& n, int const* felix_channels, struct Ladder_s* ladder_structs)
+{
+	int status = EXIT_SUCCESS;
+
+	//one range check and table lookup for all hits, FelixMap for the rest
+	if(felix < 0 || felix >= INTT::FELIX)
+	{
+		for(int i = 0; i < n; ++i)
+		{
+			if(FelixMap(felix, felix_channels[i], ladder_structs[i]) != EXIT_SUCCESS)status = EXIT_FAILURE;
+		}
+		return status;
+	}
+
+	struct FelixMapEntry_s const* entry = FelixMapTable().entry[felix];
+	for(int i = 0; i < n; ++i)
+	{
+		int const felix_channel = felix_channels[i];
+		if(felix_channel >= 0 && felix_channel < INTT::FELIX_CHANNEL && entry[felix_channel].status == EXIT_SUCCESS)
+		{
+			ladder_structs[i] = entry[felix_channel].ladder;
+			continue;
+		}
+		if(FelixMap(felix, felix_channel, ladder_structs[i]) != EXIT_SUCCESS)status = EXIT_FAILURE;
+	}
+
+	return status;
+}
@@ -12,7 +12,13 @@ namespace INTT_Felix
 		int ladder;
 	};
 
+	//the channel map itself, a switch over felix and felix channel
+	int FelixMapSwitch(int const&, int const&, struct Ladder_s&);
+	//lookup in a table built from FelixMapSwitch on first use, channels
+	//without a ladder go through the switch
 	int FelixMap(int const&, int const&, struct Ladder_s&);
+	//maps n felix channels (e.g. all hits of a packet) at once, EXIT_FAILURE if any of them failed
+	int FelixMapBatch(int const&, int const&, int const*, struct Ladder_s*);
 };
 
 #endif//FELIX_MAP_H
@@ -22,7 +22,7 @@ int InttMon::Init()
 
 	//histograms
 	NumEvents = new TH1D(Form("InttNumEvents"), Form("InttNumEvents"), 1, 0, 1);
-	HitMap = new TH1D(Form("InttMap"), Form("InttMap"), INTT::ADCS, 0, INTT::ADCS);
+	HitMap = new TH1I(Form("InttMap"), Form("InttMap"), INTT::ADCS, 0, INTT::ADCS);
 	//...
 
 	omc->registerHisto(this, NumEvents);
@@ -79,15 +79,34 @@ int InttMon::process_event(Event* evt)
 		if(!p)continue;
 
 		N = p->iValue(0, "NR_HITS");
+		if(N < 0)N = 0;
 
 		//p->identify();
 		//if(N)std::cout << N << std::endl;
 
+		//map the felix channels of all hits of the packet at once
+		m_FelixChannels.resize(N);
+		m_Ladders.resize(N);
 		for(n = 0; n < N; ++n)
 		{
-			felix_channel = p->iValue(n, "FEE");
+			m_FelixChannels[n] = p->iValue(n, "FEE");
+		}
+		int map_status = INTT_Felix::FelixMapBatch(felix, N, m_FelixChannels.data(), m_Ladders.data());
+
+		for(n = 0; n < N; ++n)
+		{
+			felix_channel = m_FelixChannels[n];
+			lddr_s = m_Ladders[n];
 
-			INTT_Felix::FelixMap(felix, felix_channel, lddr_s);
+			//hits of felix channels without a ladder are not in the hit map
+			if(map_status != EXIT_SUCCESS && INTT_Felix::FelixMap(felix, felix_channel, lddr_s) != EXIT_SUCCESS)
+			{
+				if(Verbosity() > 0)
+				{
+					std::cout << "felix " << felix << " channel " << felix_channel << " has no ladder" << std::endl;
+				}
+				continue;
+			}
 
 			indexes.lyr = lddr_s.barrel * 2 + lddr_s.layer;
 			indexes.ldr = lddr_s.ladder;
@@ -105,7 +124,8 @@ int InttMon::process_event(Event* evt)
 			//std::cout << std::endl;
 
 			INTT::GetFelixBinFromIndexes(bin, felix_channel, indexes);
-			if(bin < 0)
+			//AddBinContent does not check the range
+			if(bin < 0 || bin > INTT::ADCS)
 			{
 				std::cout << "n: " << n << std::endl;
 				std::cout << "bin: " << bin << std::endl;
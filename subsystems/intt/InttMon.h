@@ -14,6 +14,7 @@
 #include <Event/msg_profile.h>
 
 #include <TH1D.h>
+#include <TH1I.h>
 #include <TH2D.h>
 #include <TRandom.h> //for rng; remove later
 
@@ -23,6 +24,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 class InttMon : public OnlMon
 {
@@ -51,7 +53,13 @@ private:
 	int evtcnt = 0;
 
 	TH1D* NumEvents = nullptr;
-	TH1D* HitMap = nullptr;
+	//32 bit counters, bin from INTT::GetFelixBinFromIndexes. TH1I::AddBinContent stops
+	//at INT_MAX instead of wrapping, a channel would need 2^31 hits between resets
+	TH1I* HitMap = nullptr;
+
+	//felix channels and ladders of the hits of a packet, the memory is reused between events
+	std::vector<int> m_FelixChannels;
+	std::vector<struct INTT_Felix::Ladder_s> m_Ladders;
 	//...
 };
 
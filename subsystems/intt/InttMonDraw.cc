@@ -1246,7 +1246,7 @@ void InttMonDraw::PrepGlobalChipHists_Hitmap(std::string const& option, TH2D** c
 	struct INTT::Indexes_s indexes;
 
 	OnlMonClient* cl = OnlMonClient::instance();
-	TH1D* server_hist = nullptr;
+	TH1* server_hist = nullptr;
 
 	for(indexes.lyr = 0; indexes.lyr < INTT::LAYER; ++indexes.lyr)
 	{
@@ -1292,7 +1292,7 @@ void InttMonDraw::PrepGlobalChipHists_Hitmap(std::string const& option, TH2D** c
 	{
 		if(prev_felix != felix)
 		{
-			server_hist = (TH1D*)cl->getHisto(Form("INTTMON_%d", felix), "InttMap");
+			server_hist = cl->getHisto(Form("INTTMON_%d", felix), "InttMap");
 			prev_felix = felix;
 		}
 
@@ -1361,7 +1361,7 @@ void InttMonDraw::PrepLocalChannelHists_Hitmap(std::string const& option, TH2D**
 	std::string name;
 
 	OnlMonClient* cl = OnlMonClient::instance();
-	TH1D* server_hist = nullptr;
+	TH1* server_hist = nullptr;
 
 	name = Form("Intt_%s_Local_Hist_Lyr%02d_Ldr%02d_Arm%02d_Chp%02d", option.c_str(), indexes.lyr, indexes.ldr, indexes.arm, indexes.chp);
 	client_hists[0] = (TH2D*)gROOT->FindObject(name.c_str());
@@ -1400,7 +1400,7 @@ void InttMonDraw::PrepLocalChannelHists_Hitmap(std::string const& option, TH2D**
 	{
 		if(prev_felix != felix)
 		{
-			server_hist = (TH1D*)cl->getHisto(Form("INTTMON_%d", felix), "InttMap");
+			server_hist = cl->getHisto(Form("INTTMON_%d", felix), "InttMap");
 			prev_felix = felix;
 		}
 
@@ -1455,7 +1455,7 @@ void InttMonDraw::PrepGlobalChipHists_NLL(std::string const& option, TH2D** clie
 	double adc_counts[INTT::ADC] = {0};
 
 	OnlMonClient* cl = OnlMonClient::instance();
-	TH1D* server_hist = nullptr;
+	TH1* server_hist = nullptr;
 
 	for(indexes.lyr = 0; indexes.lyr < INTT::LAYER; ++indexes.lyr)
 	{
@@ -1501,7 +1501,7 @@ void InttMonDraw::PrepGlobalChipHists_NLL(std::string const& option, TH2D** clie
 	{
 		if(prev_felix != felix)
 		{
-			server_hist = (TH1D*)cl->getHisto(Form("INTTMON_%d", felix), "InttMap");
+			server_hist = cl->getHisto(Form("INTTMON_%d", felix), "InttMap");
 			prev_felix = felix;
 		}
 
@@ -1547,7 +1547,7 @@ void InttMonDraw::PrepGlobalChipHists_NLL(std::string const& option, TH2D** clie
 	{
 		if(prev_felix != felix)
 		{
-			server_hist = (TH1D*)cl->getHisto(Form("INTTMON_%d", felix), "InttMap");
+			server_hist = cl->getHisto(Form("INTTMON_%d", felix), "InttMap");
 			prev_felix = felix;
 		}
 
@@ -1658,7 +1658,7 @@ void InttMonDraw::PrepLocalChipHists_Hitmap(std::string const& option, TH2D** cl
 	std::string name;
 
 	OnlMonClient* cl = OnlMonClient::instance();
-	TH1D* server_hist = nullptr;
+	TH1* server_hist = nullptr;
 
 	name = Form("Intt_%s_Local_ClientHist_Lyr%02d_Ldr%02d_Arm%02d", option.c_str(), indexes.lyr, indexes.ldr, indexes.arm);
 	client_hists[0] = (TH2D*)gROOT->FindObject(name.c_str());
@@ -1699,7 +1699,7 @@ void InttMonDraw::PrepLocalChipHists_Hitmap(std::string const& option, TH2D** cl
 	{
 		if(prev_felix != felix)
 		{
-			server_hist = (TH1D*)cl->getHisto(Form("INTTMON_%d", felix), "InttMap");
+			server_hist = cl->getHisto(Form("INTTMON_%d", felix), "InttMap");
 			prev_felix = felix;
 		}
 
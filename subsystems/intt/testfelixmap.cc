@@ -0,0 +1,156 @@
+// the felix channel table against the switch it is built from for every felix
+// and felix channel and the ones just outside, the batch lookup of a packet,
+// and the time per hit of the switch, the table and the batch for random hits
+
+#include "InttFelixMap.h"
+#include "InttMonConstants.h"
+
+#include <onlmon/OnlMonTest.h>
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  using OnlMonTest::Check;
+
+  // ladders which no lookup writes, what is left untouched shows up
+  INTT_Felix::Ladder_s Untouched()
+  {
+    INTT_Felix::Ladder_s ladder;
+    ladder.barrel = 99;
+    ladder.layer = 99;
+    ladder.ladder = 99;
+    return ladder;
+  }
+
+  bool SameLadder(const INTT_Felix::Ladder_s &l1, const INTT_Felix::Ladder_s &l2)
+  {
+    return l1.barrel == l2.barrel && l1.layer == l2.layer && l1.ladder == l2.ladder;
+  }
+
+  // sum over the ladders of all hits, keeps the compiler from dropping the loops
+  long SwitchSum(const std::vector<int> &felix_channels, const int felix)
+  {
+    long sum = 0;
+    INTT_Felix::Ladder_s ladder;
+    for (int felix_channel : felix_channels)
+    {
+      INTT_Felix::FelixMapSwitch(felix, felix_channel, ladder);
+      sum += ladder.barrel + ladder.layer + ladder.ladder;
+    }
+    return sum;
+  }
+
+  long TableSum(const std::vector<int> &felix_channels, const int felix)
+  {
+    long sum = 0;
+    INTT_Felix::Ladder_s ladder;
+    for (int felix_channel : felix_channels)
+    {
+      INTT_Felix::FelixMap(felix, felix_channel, ladder);
+      sum += ladder.barrel + ladder.layer + ladder.ladder;
+    }
+    return sum;
+  }
+
+  long BatchSum(const std::vector<int> &felix_channels, const int felix, std::vector<INTT_Felix::Ladder_s> &ladders)
+  {
+    long sum = 0;
+    INTT_Felix::FelixMapBatch(felix, felix_channels.size(), felix_channels.data(), ladders.data());
+    for (auto &ladder : ladders)
+    {
+      sum += ladder.barrel + ladder.layer + ladder.ladder;
+    }
+    return sum;
+  }
+}  // namespace
+
+int main()
+{
+  bool same = true;
+  int nladders = 0;
+  for (int felix = -1; felix <= INTT::FELIX; felix++)
+  {
+    for (int felix_channel = -1; felix_channel <= INTT::FELIX_CHANNEL; felix_channel++)
+    {
+      INTT_Felix::Ladder_s fromswitch = Untouched();
+      INTT_Felix::Ladder_s fromtable = Untouched();
+      int switchstatus = INTT_Felix::FelixMapSwitch(felix, felix_channel, fromswitch);
+      int tablestatus = INTT_Felix::FelixMap(felix, felix_channel, fromtable);
+      if (switchstatus != tablestatus || !SameLadder(fromswitch, fromtable))
+      {
+        std::cout << "felix " << felix << " channel " << felix_channel << ": switch " << switchstatus << " "
+                  << fromswitch.barrel << " " << fromswitch.layer << " " << fromswitch.ladder << ", table " << tablestatus << " "
+                  << fromtable.barrel << " " << fromtable.layer << " " << fromtable.ladder << std::endl;
+        same = false;
+      }
+      nladders += (switchstatus == EXIT_SUCCESS);
+    }
+  }
+  Check(same, "table gives the status and ladder of the switch for every felix and felix channel");
+  Check(nladders == INTT::FELIX * INTT::FELIX_CHANNEL, "every felix channel has a ladder");
+
+  // a packet with a few channels no felix has
+  std::mt19937 rng(4711);
+  std::uniform_int_distribution<int> channel(0, INTT::FELIX_CHANNEL - 1);
+  std::vector<int> felix_channels(1000);
+  for (auto &felix_channel : felix_channels)
+  {
+    felix_channel = channel(rng);
+  }
+  for (int felix = 0; felix < INTT::FELIX; felix++)
+  {
+    std::vector<INTT_Felix::Ladder_s> ladders(felix_channels.size(), Untouched());
+    Check(INTT_Felix::FelixMapBatch(felix, felix_channels.size(), felix_channels.data(), ladders.data()) == EXIT_SUCCESS,
+          "batch of felix " + std::to_string(felix) + " succeeds");
+    bool batch = true;
+    for (unsigned int i = 0; i < felix_channels.size(); i++)
+    {
+      INTT_Felix::Ladder_s fromswitch = Untouched();
+      INTT_Felix::FelixMapSwitch(felix, felix_channels[i], fromswitch);
+      batch = batch && SameLadder(fromswitch, ladders[i]);
+    }
+    Check(batch, "batch of felix " + std::to_string(felix) + " gives the ladders of the switch");
+  }
+  std::vector<int> bad = felix_channels;
+  bad[17] = INTT::FELIX_CHANNEL;
+  bad[500] = -3;
+  std::vector<INTT_Felix::Ladder_s> ladders(bad.size());
+  Check(INTT_Felix::FelixMapBatch(0, bad.size(), bad.data(), ladders.data()) == EXIT_FAILURE, "batch with a channel without ladder fails");
+
+  // what mapping the hits costs, random hits of all felix channels
+  const int nhits = 10000000;
+  std::vector<int> hits(nhits);
+  for (auto &felix_channel : hits)
+  {
+    felix_channel = channel(rng);
+  }
+  long switchsum = 0;
+  long tablesum = 0;
+  long batchsum = 0;
+  ladders.resize(nhits);
+  auto perswitch = [&]()
+  {
+    switchsum = SwitchSum(hits, 5);
+  };
+  auto pertable = [&]()
+  {
+    tablesum = TableSum(hits, 5);
+  };
+  auto perbatch = [&]()
+  {
+    batchsum = BatchSum(hits, 5, ladders);
+  };
+  double switchseconds = OnlMonTest::Seconds(perswitch);
+  double tableseconds = OnlMonTest::Seconds(pertable);
+  double batchseconds = OnlMonTest::Seconds(perbatch);
+  std::cout << "ns per hit: " << 1e9 * switchseconds / nhits << " switch, " << 1e9 * tableseconds / nhits
+            << " table, " << 1e9 * batchseconds / nhits << " batch" << std::endl;
+  Check(switchsum == tablesum && switchsum == batchsum, "same ladders for the random hits");
+  Check(tableseconds < switchseconds, "table is faster than the switch");
+
+  return (OnlMonTest::Summary()) ? 1 : 0;
+}
@@ -28,6 +28,7 @@
 #include <Event/Event.h>
 #include <Event/packet.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>  // for printf
 #include <fstream>
@@ -258,6 +259,13 @@ int MvtxMon::Init()
   hChipHitmap->SetStats(0);
   se->registerHisto(this, hChipHitmap);
 
+  mPacketBuffer.resize(mPacketCapacity + 1);
+  hPacketsPerEvent = new TH1I("MVTXMON_General_PacketsPerEvent", "Packets per RCDAQ event", mPacketCapacity + 2, -0.5, mPacketCapacity + 1.5);
+  hPacketsPerEvent->GetXaxis()->SetTitle(Form("Packets (%d: more than decoded)", mPacketCapacity + 1));
+  hPacketsPerEvent->GetYaxis()->SetTitle("Counts");
+  hPacketsPerEvent->SetStats(0);
+  se->registerHisto(this, hPacketsPerEvent);
+
   hChipStrobes = new TH1I("hChipStrobes", "Chip Strobes vs Chip*Stave", 8*9*6,-.5,8*9*6-0.5);
   hChipStrobes->GetXaxis()->SetTitle("Chip*Stave");
   hChipStrobes->GetYaxis()->SetTitle("Counts");
@@ -354,7 +362,6 @@ int MvtxMon::process_event(Event *evt)
   //std::cout << "Processing Event " << evtcnt << std::endl;
   OnlMonServer *se = OnlMonServer::instance();
 
-  plist = new Packet *[2];
    //SingleMvtxInput *reader = new SingleMvtxInput("onlmonreader");
 
   for(int l = 0; l < NLAYERS; l++){
@@ -364,47 +371,46 @@ int MvtxMon::process_event(Event *evt)
       }
     }
   }
-  hChipHitmap_evt->Reset("ICESM");
+  ClearEventHitmap();
 
    int nChipStrobes[8*9*6] = {0};
 
 
-   int npackets = evt->getPacketList(plist, 2);
-
-    if (npackets > 2)
-    {
-      exit(1);
-    }
+   // one slot more than we decode tells us if there are more packets
+   int npackets = KeepPackets(evt->getPacketList(mPacketBuffer.data(), mPacketBuffer.size()));
 
+    mHits.clear();
     for (int i = 0; i < npackets; i++)
     {
+      Packet *pkt = mPacketBuffer[i];
       // Ignoring packet not from MVTX detector
-      if ( (plist[i]->getIdentifier() < 2001) || (plist[i]->getIdentifier() > 2052) )
+      if ( (pkt->getIdentifier() < 2001) || (pkt->getIdentifier() > 2052) )
       {
+        delete pkt;
         continue;
       }
       if (Verbosity() > 1)
       {
-        plist[i]->identify();
+        pkt->identify();
       }
-      int num_feeId = plist[i]->iValue(-1, "NR_LINKS");
+      int num_feeId = pkt->iValue(-1, "NR_LINKS");
       if (Verbosity()  > 1)
       {
         std::cout << "Number of feeid in RCDAQ events: " << num_feeId << " for packet "
-          << plist[i]->getIdentifier() << std::endl;
+          << pkt->getIdentifier() << std::endl;
       }
       if (num_feeId > 0)
       {
         for (int i_fee{0}; i_fee < num_feeId; ++i_fee)
         {
-          auto feeId = plist[i]->iValue(i_fee, "FEEID");
+          auto feeId = pkt->iValue(i_fee, "FEEID");
           auto link = DecodeFeeid(feeId);
-          auto num_strobes = plist[i]->iValue(feeId, "NR_STROBES");
+          auto num_strobes = pkt->iValue(feeId, "NR_STROBES");
           ntriggers = num_strobes;
-          auto num_L1Trgs = plist[i]->iValue(feeId, "NR_PHYS_TRG");
+          auto num_L1Trgs = pkt->iValue(feeId, "NR_PHYS_TRG");
           for ( int iL1 = 0; iL1 < num_L1Trgs; ++iL1 )
           {
-            //auto l1Trg_bco = plist[i]->lValue(feeId, iL1, "L1_IR_BCO");
+            //auto l1Trg_bco = pkt->lValue(feeId, iL1, "L1_IR_BCO");
             hChipL1->Fill((StaveBoundary[link.layer]+link.stave)*9 + 3 * link.gbtid + 0); //same for chip id 0 1 and 2
 	    hChipL1->Fill((StaveBoundary[link.layer]+link.stave)*9 + 3 * link.gbtid + 1);
 	    hChipL1->Fill((StaveBoundary[link.layer]+link.stave)*9 + 3 * link.gbtid + 2);
@@ -413,9 +419,9 @@ int MvtxMon::process_event(Event *evt)
           //m_FeeStrobeMap[feeId] += num_strobes;
           for (int i_strb{0}; i_strb < num_strobes; ++i_strb)
           {
-            auto strb_bco = plist[i]->lValue(feeId, i_strb, "TRG_IR_BCO");
-            //auto strb_bc  = plist[i]->iValue(feeId, i_strb, "TRG_IR_BC");
-            auto num_hits = plist[i]->iValue(feeId, i_strb, "TRG_NR_HITS");
+            auto strb_bco = pkt->lValue(feeId, i_strb, "TRG_IR_BCO");
+            //auto strb_bc  = pkt->iValue(feeId, i_strb, "TRG_IR_BC");
+            auto num_hits = pkt->iValue(feeId, i_strb, "TRG_NR_HITS");
             if (Verbosity() > 4)
             {
  	      if(link.layer == 0){
@@ -431,36 +437,35 @@ int MvtxMon::process_event(Event *evt)
 	    nChipStrobes[(StaveBoundary[link.layer]+link.stave%20)*9 + 3 * link.gbtid + 0]++;
 	    nChipStrobes[(StaveBoundary[link.layer]+link.stave%20)*9 + 3 * link.gbtid + 1]++;
             nChipStrobes[(StaveBoundary[link.layer]+link.stave%20)*9 + 3 * link.gbtid + 2]++;
+            for (int ichip = 0; ichip < 3; ichip++)
+            {
+              AddChipCount(mChipStrobeCount, (StaveBoundary[link.layer]+link.stave%20)*9 + 3 * link.gbtid + ichip);
+            }
 
-           
-            
-
+            // only collect the hits here, they are histogrammed below
             for (int i_hit{0}; i_hit < num_hits; ++i_hit)
             {
-              //auto chip_bc = plist[i]->iValue(feeId, i_strb, i_hit, "HIT_BC");
-              auto chip_id = plist[i]->iValue(feeId, i_strb, i_hit, "HIT_CHIP_ID");
-              auto chip_row = plist[i]->iValue(feeId, i_strb, i_hit, "HIT_ROW");
-              auto chip_col = plist[i]->iValue(feeId, i_strb, i_hit, "HIT_COL");
-
-              mHitPerChip[link.layer][link.stave%20][3 * link.gbtid + chip_id]++;
-              hChipHitmap->Fill(chip_col,chip_row,(StaveBoundary[link.layer]+link.stave%20)*9 + 3 * link.gbtid + chip_id);
-              hChipStaveOccupancy[link.layer]->Fill(3 * link.gbtid + chip_id, link.stave%20);
-	      hChipHitmap_evt->Fill(chip_col,chip_row,(StaveBoundary[link.layer]+link.stave%20)*9 + 3 * link.gbtid + chip_id);
-
+              //auto chip_bc = pkt->iValue(feeId, i_strb, i_hit, "HIT_BC");
+              PixelHit hit;
+              hit.layer = link.layer;
+              hit.stave = link.stave % 20;
+              hit.chip = 3 * link.gbtid + pkt->iValue(feeId, i_strb, i_hit, "HIT_CHIP_ID");
+              hit.row = pkt->iValue(feeId, i_strb, i_hit, "HIT_ROW");
+              hit.col = pkt->iValue(feeId, i_strb, i_hit, "HIT_COL");
+              mHits.push_back(hit);
             }
 
-	    
-		
-
             //m_BeamClockFEE[strb_bco].insert(feeId);
             //m_BclkStack.insert(strb_bco);
            // m_FEEBclkMap[feeId] = strb_bco;
           }
         }
       }
-      delete plist[i];
+      delete pkt;
     }
 
+    FillHits();
+
 	int firedChips = 0;
         int firedPixels = 0;
         int sumstrobes = 0;
@@ -481,32 +486,13 @@ int MvtxMon::process_event(Event *evt)
 	    mvtxmon_ChipFiredHis->Fill(firedChips);
            mvtxmon_EvtHitDis->Fill((double)firedPixels/((double)sumstrobes/(double)nstrobes));
 
-  double pixelOccupancy, chipOccupancy;
-  for (int iLayer = 0; iLayer < 3; iLayer++) {
-    for (int iStave = 0; iStave < NStaves[iLayer]; iStave++) {
-      for (int iChip = 0; iChip < 9; iChip++) {
-        chipOccupancy = hChipHitmap->Integral(0,-1,0,-1,(StaveBoundary[iLayer]+iStave)*9+iChip+1,(StaveBoundary[iLayer]+iStave)*9+iChip+1); //scale at client
-        double chipOccupancyNorm = chipOccupancy/hChipStrobes->GetBinContent((StaveBoundary[iLayer]+iStave)*9+iChip+1)/1024/512;
-         //if (chipOccupancyNorm > 0) mvtxmon_ChipStave1D->SetBinContent((iLayer==0?iStave:NStaves[iLayer]+iStave)*9+iChip+1,chipOccupancyNorm); //need to remember total number of occ and events and scale here
-         if (chipOccupancyNorm > 0)mvtxmon_ChipStave1D->SetBinContent((StaveBoundary[iLayer]+iStave)*9 + iChip +1,chipOccupancyNorm); 
-         if (chipOccupancyNorm > 0)mGeneralOccupancy->SetBinContent(mapstave[iLayer][iStave], chipOccupancyNorm);
-        int nTrg = nChipStrobes[(StaveBoundary[iLayer]+iStave)*9+iChip];
-        for (int iCol = 0; iCol < NCols; iCol++) {
-          for (int iRow = 0; iRow < NRows; iRow++) {
-            pixelOccupancy = hChipHitmap_evt->GetBinContent(iCol + 1, iRow + 1,(StaveBoundary[iLayer]+iStave)*9+iChip+1);
-            if (pixelOccupancy > 0) {
-              if (pixelOccupancy/(double)nTrg > mOccupancyCutForNoisyPixel) {
-                  mNoisyPixelNumber[iLayer][iStave][iChip]++;
-                  mOccupancyPlot[iLayer]->Fill(log10(pixelOccupancy/(double)nTrg));
-              }                         
-              hOccupancyPlot[iLayer]->Fill(log10(pixelOccupancy/(double)nTrg));
-            }
-          }
-        }
-      }      
-    }
+  if (evtcnt % mOccupancyInterval == 0)
+  {
+    UpdateChipOccupancy();
   }
 
+  PixelOccupancy(nChipStrobes);
+
   for (int iLayer = 0; iLayer < 3; iLayer++) {
     for (int iStave = 0; iStave < NStaves[iLayer]; iStave++) {
       for (int iChip = 0; iChip < 9; iChip++) {
@@ -520,14 +506,12 @@ int MvtxMon::process_event(Event *evt)
 for (int iLayer = 0; iLayer < 3; iLayer++) {
     for (int iStave = 0; iStave < NStaves[iLayer]; iStave++) {
       for (int iChip = 0; iChip < 9; iChip++) {
-        if (!mHitPerChip[iLayer][iStave][iChip]) {
-          if(mDeadChipPos[iLayer]->GetBinContent(mDeadChipPos[iLayer]->GetXaxis()->FindBin(iChip), mDeadChipPos[iLayer]->GetYaxis()->FindBin(iStave)) > 0.5) mDeadChipPos[iLayer]->SetBinContent(mDeadChipPos[iLayer]->GetXaxis()->FindBin(iChip), mDeadChipPos[iLayer]->GetYaxis()->FindBin(iStave), 1);
-          if(mTotalDeadChipPos->GetBinContent(mTotalDeadChipPos->GetXaxis()->FindBin(iChip), mTotalDeadChipPos->GetYaxis()->FindBin(iStave)) > 0.5) mTotalDeadChipPos->SetBinContent(mTotalDeadChipPos->GetXaxis()->FindBin(iChip), mTotalDeadChipPos->GetYaxis()->FindBin(iStave), 1);
-        } else {
+        // chips without hits keep their dead flag, bins are chip+1, stave+1
+        if (mHitPerChip[iLayer][iStave][iChip]) {
 	  mAliveChipPos[iLayer]->Fill(iChip, iStave);
           mTotalAliveChipPos->Fill(iChip, iStave);
-          mDeadChipPos[iLayer]->SetBinContent(mDeadChipPos[iLayer]->GetXaxis()->FindBin(iChip), mDeadChipPos[iLayer]->GetYaxis()->FindBin(iStave), 0);                // not dead
-          mTotalDeadChipPos->SetBinContent(mTotalDeadChipPos->GetXaxis()->FindBin(iChip), mTotalDeadChipPos->GetYaxis()->FindBin(iStave), 0); // not dead
+          mDeadChipPos[iLayer]->SetBinContent(iChip + 1, iStave + 1, 0);                // not dead
+          mTotalDeadChipPos->SetBinContent(iChip + 1, iStave + 1, 0); // not dead
         }
       }
     }
@@ -586,10 +570,169 @@ int MvtxMon::Reset()
   // reset our internal counters
   evtcnt = 0;
   idummy = 0;
+  ClearEventHitmap();
+  std::fill(mChipHitCount, mChipHitCount + NSTAVE * NCHIP, 0);
+  std::fill(mChipStrobeCount, mChipStrobeCount + NSTAVE * NCHIP, 0);
   return 0;
 }
 
 
+void MvtxMon::ClearEventHitmap()
+{
+  // zero only the pixels set in the last event instead of the full TH3
+  if (!hChipHitmap_evt)
+  {
+    return;
+  }
+  for (auto evtbin : mEvtPixels)
+  {
+    hChipHitmap_evt->SetBinContent(evtbin, 0);
+  }
+  hChipHitmap_evt->SetEntries(0);
+  mEvtPixels.clear();
+  return;
+}
+
+void MvtxMon::PixelOccupancy(const int *nChipStrobes)
+{
+  double pixelOccupancy;
+  // only the pixels hit in this event have a non zero occupancy
+  for (auto evtbin : mEvtPixels) {
+    int iCol, iRow, iChipStave;
+    hChipHitmap_evt->GetBinXYZ(evtbin, iCol, iRow, iChipStave);
+    if (iCol < 1 || iCol > NCols || iRow < 1 || iRow > NRows || iChipStave < 1 || iChipStave > NSTAVE * NCHIP) {
+      continue;  // under/overflow
+    }
+    int gstave = (iChipStave - 1) / 9;
+    int iChip = (iChipStave - 1) % 9;
+    int iLayer = (gstave < StaveBoundary[1]) ? 0 : ((gstave < StaveBoundary[2]) ? 1 : 2);
+    int iStave = gstave - StaveBoundary[iLayer];
+    int nTrg = nChipStrobes[iChipStave - 1];
+    pixelOccupancy = hChipHitmap_evt->GetBinContent(evtbin);
+    if (pixelOccupancy/(double)nTrg > mOccupancyCutForNoisyPixel) {
+        mNoisyPixelNumber[iLayer][iStave][iChip]++;
+        mOccupancyPlot[iLayer]->Fill(log10(pixelOccupancy/(double)nTrg));
+    }
+    hOccupancyPlot[iLayer]->Fill(log10(pixelOccupancy/(double)nTrg));
+  }
+  return;
+}
+
+void MvtxMon::UpdateChipOccupancy()
+{
+  // hits per strobe and pixel since the last reset
+  for (int iLayer = 0; iLayer < NLAYERS; iLayer++) {
+    for (int iStave = 0; iStave < NStaves[iLayer]; iStave++) {
+      for (int iChip = 0; iChip < NCHIP; iChip++) {
+        int chipidx = (StaveBoundary[iLayer]+iStave)*9 + iChip;
+        if (mChipHitCount[chipidx] == 0 || mChipStrobeCount[chipidx] == 0) {
+          continue;
+        }
+        double chipOccupancyNorm = (double) mChipHitCount[chipidx]/mChipStrobeCount[chipidx]/NCols/NRows;  //scale at client
+        mvtxmon_ChipStave1D->SetBinContent(chipidx + 1, chipOccupancyNorm);
+        mGeneralOccupancy->SetBinContent(mapstave[iLayer][iStave], chipOccupancyNorm);
+      }
+    }
+  }
+  return;
+}
+
+int MvtxMon::KeepPackets(const int npackets)
+{
+  hPacketsPerEvent->Fill(npackets);
+  if (npackets <= mPacketCapacity)
+  {
+    return npackets;
+  }
+  // more packets than we decode, they are only counted
+  for (int i = mPacketCapacity; i < npackets; i++)
+  {
+    delete mPacketBuffer[i];
+    mPacketBuffer[i] = nullptr;
+  }
+  return mPacketCapacity;
+}
+
+void MvtxMon::PacketCapacity(const int npackets)
+{
+  if (npackets < 1)
+  {
+    std::cout << "PacketCapacity: " << npackets << " packets per event is not possible, using 1" << std::endl;
+    mPacketCapacity = 1;
+    return;
+  }
+  mPacketCapacity = npackets;
+  return;
+}
+
+void MvtxMon::OccupancyUpdateInterval(const int nevents)
+{
+  mOccupancyInterval = (nevents > 0) ? nevents : 1;
+  return;
+}
+
+void MvtxMon::ChipProjections(const int rebin)
+{
+  // chip projections have to keep the chip boundaries
+  if (rebin < 0 || (rebin > 0 && (NRows % rebin || NCols % rebin)))
+  {
+    std::cout << "ChipProjections: rebin factor " << rebin << " does not divide "
+              << NCols << " and " << NRows << ", chip projections stay off" << std::endl;
+    mChipProjRebin = 0;
+    return;
+  }
+  mChipProjRebin = rebin;
+  return;
+}
+
+void MvtxMon::FillHits()
+{
+  for (auto &hit : mHits)
+  {
+    int gstave = StaveBoundary[hit.layer] + hit.stave;
+    mHitPerChip[hit.layer][hit.stave][hit.chip]++;
+    AddChipCount(mChipHitCount, gstave*9 + hit.chip);
+    hChipHitmap->Fill(hit.col,hit.row,gstave*9 + hit.chip);
+    hChipStaveOccupancy[hit.layer]->Fill(hit.chip, hit.stave);
+    int evtbin = hChipHitmap_evt->FindFixBin(hit.col,hit.row,gstave*9 + hit.chip);
+    if (hChipHitmap_evt->GetBinContent(evtbin) == 0)
+    {
+      mEvtPixels.push_back(evtbin);
+    }
+    hChipHitmap_evt->AddBinContent(evtbin);
+    if (mChipProjRebin > 0)
+    {
+      TH2I *stavemap = StaveHitmap(hit.layer, hit.stave);
+      if (stavemap)
+      {
+        stavemap->Fill(NCols * hit.chip + hit.col, hit.row);
+      }
+    }
+  }
+  return;
+}
+
+TH2I *MvtxMon::StaveHitmap(const int layer, const int stave)
+{
+  if (stave >= NStaves[layer])
+  {
+    return nullptr;
+  }
+  int gstave = StaveBoundary[layer] + stave;
+  if (!hStaveHitmap[gstave])
+  {
+    // the staves of a server follow from the feeids it decodes, the map is
+    // registered the first time one of its chips has a hit
+    OnlMonServer *se = OnlMonServer::instance();
+    hStaveHitmap[gstave] = new TH2I(Form("MVTXMON_staveHitmap_L%d_S%d", layer, stave), Form("MVTX Layer %d Stave %d Hitmap", layer, stave), NCHIP * NCols / mChipProjRebin, -.5, NCHIP * NCols - .5, NRows / mChipProjRebin, -.5, NRows - .5);
+    hStaveHitmap[gstave]->GetXaxis()->SetTitle("Chip*1024+Col");
+    hStaveHitmap[gstave]->GetYaxis()->SetTitle("Row");
+    hStaveHitmap[gstave]->SetStats(0);
+    se->registerHisto(this, hStaveHitmap[gstave]);
+  }
+  return hStaveHitmap[gstave];
+}
+
 void MvtxMon::getStavePoint(int layer, int stave, double* px, double* py)
 {
   float stepAngle = M_PI * 2 / NStaves[layer];              // the angle between to stave
@@ -8,6 +8,7 @@
 
 #include <map>
 #include <cmath>
+#include <vector>
 
 
 class Event;
@@ -35,6 +36,14 @@ class MvtxMon : public OnlMon
   int Init();
   int BeginRun(const int runno);
   int Reset();
+  // maintain 2D hitmaps per stave (columns of a chip rebinned by this factor)
+  // for the staves this server reads out, 0: off. Has to be set before Init()
+  void ChipProjections(const int rebin);
+  int ChipProjections() const { return mChipProjRebin; }
+  // recalculate the chip occupancies every nevents events (default 1)
+  void OccupancyUpdateInterval(const int nevents);
+  // packets decoded per event (default 2), additional ones are only counted. Has to be set before Init()
+  void PacketCapacity(const int npackets);
 
 
  protected:
@@ -50,6 +59,10 @@ class MvtxMon : public OnlMon
   static constexpr int NCols = 1024;
   static constexpr int NRows = 512;
   int mHitPerChip[NLAYERS][NSTAVE][NCHIP] = {};
+  // hits and strobes per chip (stave*9+chip) since the last reset, the chip occupancy is calculated from them
+  long mChipHitCount[NSTAVE * NCHIP] = {};
+  long mChipStrobeCount[NSTAVE * NCHIP] = {};
+  int mOccupancyInterval = 1;
   static constexpr int NFlags = 3;
 
   int mMaxGeneralAxisRange = -3;  // the range of TH2Poly plots z axis range, pow(10, mMinGeneralAxisRange) ~ pow(10, mMaxGeneralAxisRange)
@@ -90,6 +103,9 @@ class MvtxMon : public OnlMon
   TH2D* hChipStaveOccupancy[NLAYERS] = {nullptr};
   TH3I* hChipHitmap = nullptr;
   TH3I* hChipHitmap_evt = nullptr;
+  std::vector<int> mEvtPixels;  // bins of hChipHitmap_evt set in this event
+  TH2I* hStaveHitmap[NSTAVE] = {nullptr};
+  int mChipProjRebin = 0;
 
   //fhr
   TH2I* mErrorVsFeeid= nullptr;
@@ -149,14 +165,44 @@ class MvtxMon : public OnlMon
     return ret;
   }
 
+  void ClearEventHitmap();
+  // occupancy distributions and noisy pixels of the pixels hit in this event
+  void PixelOccupancy(const int *nChipStrobes);
+  void UpdateChipOccupancy();
+  void AddChipCount(long *counts, const int chipidx)
+  {
+    if (chipidx >= 0 && chipidx < NSTAVE * NCHIP)
+    {
+      counts[chipidx]++;
+    }
+  }
+  // counts the packets getPacketList put into mPacketBuffer, deletes the ones
+  // beyond mPacketCapacity and returns the number of packets to decode
+  int KeepPackets(const int npackets);
+  // histograms the decoded hits of the event
+  void FillHits();
+  // stave hitmap of the chip projections, created with the first hit of the stave
+  TH2I *StaveHitmap(const int layer, const int stave);
+
+  struct PixelHit
+  {
+    int layer = 0;
+    int stave = 0;  // in layer
+    int chip = 0;   // in stave
+    int row = 0;
+    int col = 0;
+  };
+  int mPacketCapacity = 2;
+  std::vector<Packet *> mPacketBuffer;  // mPacketCapacity + 1 to see if there are more packets
+  std::vector<PixelHit> mHits;          // hits of the current event, the memory is reused
+  TH1I *hPacketsPerEvent = nullptr;
+
   private:
   unsigned short decode_row(int hit){	return hit >> 16;}
   unsigned short decode_col(int hit){	return hit & 0xffff;}
   void getStavePoint(int layer, int stave, double* px, double* py);
   void drawLayerName(TH2* histo2D);
   void createPoly(TH2Poly *h);
-
-  Packet **plist = nullptr;
   /*unsigned int m_NumSpecialEvents = 0;
   std::map<uint64_t, std::set<int>> m_BeamClockFEE;
   std::map<uint64_t, std::vector<MvtxRawHit *>> m_MvtxRawHitMap;
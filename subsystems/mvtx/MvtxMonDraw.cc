@@ -44,6 +44,25 @@ MvtxMonDraw::MvtxMonDraw(const std::string &name)
 
 int MvtxMonDraw::Init()
 {
+  OnlMonClient *cl = OnlMonClient::instance();
+  if (m_FullHitmap)
+  {
+    // the chip hitmap is the largest histogram, let the client merge it once per update
+    for (int iFelix = 0; iFelix < NFlx; iFelix++){
+      cl->addMergeSource("MVTXMON", "MVTXMON_chipHitmap", Form("MVTXMON_%d",iFelix), Form("MVTXMON_chipHitmapFLX%d", iFelix));
+    }
+    return 0;
+  }
+  // the servers project the hitmap per stave, these are a fraction of the TH3
+  std::vector<std::string> servers;
+  for (int iFelix = 0; iFelix < NFlx; iFelix++){
+    servers.push_back(Form("MVTXMON_%d",iFelix));
+  }
+  for (int aLayer = 0; aLayer < NLAYERS; aLayer++) {
+    for (int aStave = 0; aStave < NStaves[aLayer]; aStave++) {
+      cl->registerMergedHisto("MVTXMON", Form("MVTXMON_staveHitmap_L%d_S%d", aLayer, aStave), servers);
+    }
+  }
   return 0;
 }
 
@@ -291,30 +310,35 @@ int MvtxMonDraw::DrawHitMap(const std::string &what )
   int ipad = 0;
   int returnCode = 0;
 
-  for (int iFelix = 0; iFelix <NFlx; iFelix++){
-    mvtxmon_HitMap[iFelix] = dynamic_cast<TH3*>(cl->getHisto(Form("MVTXMON_%d",iFelix),Form("MVTXMON_chipHitmapFLX%d", iFelix)));
-  }
-  MergeServers<TH3*>(mvtxmon_HitMap);
-  if(mvtxmon_HitMap[NFlx]){
-    mvtxmon_HitMap[NFlx]->GetXaxis()->CenterTitle();
-    mvtxmon_HitMap[NFlx]->GetYaxis()->CenterTitle();
-    mvtxmon_HitMap[NFlx]->GetYaxis()->SetTitleOffset(1.4);
-    mvtxmon_HitMap[NFlx]->GetXaxis()->SetTitleOffset(0.75);
-    mvtxmon_HitMap[NFlx]->GetXaxis()->SetTitleSize(0.06);
-    mvtxmon_HitMap[NFlx]->GetYaxis()->SetTitleOffset(0.75);
-    mvtxmon_HitMap[NFlx]->GetYaxis()->SetTitleSize(0.06);
+  if (!m_FullHitmap)
+  {
+    returnCode += DrawStaveHitMaps(aLs, aLe, aSs, aSe);
   }
+  else
+  {
+    mvtxmon_HitMap[NFlx] = dynamic_cast<TH3*>(cl->getHisto("MVTXMON","MVTXMON_chipHitmap"));
+    if(mvtxmon_HitMap[NFlx]){
+      mvtxmon_HitMap[NFlx]->GetXaxis()->CenterTitle();
+      mvtxmon_HitMap[NFlx]->GetYaxis()->CenterTitle();
+      mvtxmon_HitMap[NFlx]->GetYaxis()->SetTitleOffset(1.4);
+      mvtxmon_HitMap[NFlx]->GetXaxis()->SetTitleOffset(0.75);
+      mvtxmon_HitMap[NFlx]->GetXaxis()->SetTitleSize(0.06);
+      mvtxmon_HitMap[NFlx]->GetYaxis()->SetTitleOffset(0.75);
+      mvtxmon_HitMap[NFlx]->GetYaxis()->SetTitleSize(0.06);
+    }
 
-  for (int aLayer = aLs; aLayer < aLe; aLayer++) {
-    for (int aStave = aSs; aStave < aSe; aStave++) {
-      for (int iChip = 0; iChip < 9; iChip++) {
-        //int stave = aLayer==0?aStave:NStaves[aLayer]+aStave;
-	TString prefix = Form("%d%d%d",aLayer,aStave,iChip);
-        mvtxmon_HitMap[NFlx]->GetZaxis()->SetRange(((chipmapoffset[aLayer]+aStave)*9+iChip+1),((chipmapoffset[aLayer]+aStave)*9+iChip+1));
-        returnCode += PublishHistogram(Pad[padID],ipad*9+iChip+1,mvtxmon_HitMap[NFlx]->Project3D(prefix+"yx"),"colz"); //publish merged one
-	gStyle->SetOptStat(0);
+    for (int aLayer = aLs; aLayer < aLe; aLayer++) {
+      for (int aStave = aSs; aStave < aSe; aStave++) {
+        for (int iChip = 0; iChip < 9; iChip++) {
+          //int stave = aLayer==0?aStave:NStaves[aLayer]+aStave;
+          TString prefix = Form("%d%d%d",aLayer,aStave,iChip);
+          if (!mvtxmon_HitMap[NFlx]) continue;
+          mvtxmon_HitMap[NFlx]->GetZaxis()->SetRange(((chipmapoffset[aLayer]+aStave)*9+iChip+1),((chipmapoffset[aLayer]+aStave)*9+iChip+1));
+          returnCode += PublishHistogram(Pad[padID],ipad*9+iChip+1,mvtxmon_HitMap[NFlx]->Project3D(prefix+"yx"),"colz"); //publish merged one
+          gStyle->SetOptStat(0);
+        }
+        ipad++;
       }
-      ipad++;
     }
   }
 
@@ -360,6 +384,53 @@ int MvtxMonDraw::DrawHitMap(const std::string &what )
   return returnCode < 0 ? -1 : 0;
 }
 
+int MvtxMonDraw::DrawStaveHitMaps(const int aLs, const int aLe, const int aSs, const int aSe)
+{
+  OnlMonClient *cl = OnlMonClient::instance();
+  const int padID = 0;
+  int ipad = 0;
+  int returnCode = 0;
+  for (int aLayer = aLs; aLayer < aLe; aLayer++) {
+    for (int aStave = aSs; aStave < aSe; aStave++) {
+      // the servers create a stave hitmap with the first hit of the stave
+      TH2 *stavemap = dynamic_cast<TH2*>(cl->getHisto("MVTXMON", Form("MVTXMON_staveHitmap_L%d_S%d", aLayer, aStave)));
+      for (int iChip = 0; iChip < NCHIP; iChip++) {
+        if (!stavemap) {
+          continue;
+        }
+        TString hname = Form("MVTXMON_chipHitmap_L%d_S%d_C%d", aLayer, aStave, iChip);
+        returnCode += PublishHistogram(Pad[padID], ipad*9+iChip+1, ChipHitMap(stavemap, iChip, hname), "colz");
+        gStyle->SetOptStat(0);
+      }
+      ipad++;
+    }
+  }
+  return returnCode;
+}
+
+TH2 *MvtxMonDraw::ChipHitMap(TH2 *stavemap, const int chip, const TString &hname)
+{
+  // the chips sit side by side along x in the stave hitmap
+  int nx = stavemap->GetNbinsX() / NCHIP;
+  int ny = stavemap->GetNbinsY();
+  TH2 *h = dynamic_cast<TH2*>(gROOT->FindObject(hname));
+  if (!h || h->GetNbinsX() != nx || h->GetNbinsY() != ny)
+  {
+    delete h;
+    h = new TH2I(hname, hname, nx, -.5, NCols - .5, ny, -.5, NRows - .5);
+    h->GetXaxis()->SetTitle("Col");
+    h->GetYaxis()->SetTitle("Row");
+    h->SetStats(0);
+  }
+  h->Reset();
+  for (int ix = 1; ix <= nx; ix++) {
+    for (int iy = 1; iy <= ny; iy++) {
+      h->SetBinContent(ix, iy, stavemap->GetBinContent(chip * nx + ix, iy));
+    }
+  }
+  return h;
+}
+
 int MvtxMonDraw::DrawGeneral(const std::string & /* what */)
 {
   OnlMonClient *cl = OnlMonClient::instance();
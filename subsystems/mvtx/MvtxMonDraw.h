@@ -13,6 +13,8 @@ class TPad;
 class OnlMonClient;
 class TPaveText;
 class TH1;
+class TH2;
+class TString;
 class TH2Poly;
 
 
@@ -27,6 +29,9 @@ class MvtxMonDraw : public OnlMonDraw
   int Draw(const std::string &what = "ALL") override;
   int MakeHtml(const std::string &what = "ALL") override;
   int SavePlot(const std::string &what = "ALL", const std::string &type = "png") override;
+  //! draw the hitmaps from the merged TH3 instead of the per stave
+  //! projections of the servers, has to be set before Init()
+  void FullHitmap(const int i) { m_FullHitmap = i; }
 
      const static int NSTAVE = 48;
   const static int NCHIP = 9;
@@ -59,6 +64,8 @@ static const int NFlx = 6;
   int DrawFirst(const std::string &what = "ALL");
   int DrawSecond(const std::string &what = "ALL");
   int DrawHitMap(const std::string &what = "ALL");
+  int DrawStaveHitMaps(const int aLs, const int aLe, const int aSs, const int aSe);
+  TH2 *ChipHitMap(TH2 *stavemap, const int chip, const TString &hname);
   int DrawGeneral(const std::string &what = "ALL");
   int DrawFEE(const std::string &what = "ALL");
   int DrawOCC(const std::string &what = "ALL");
@@ -71,6 +78,7 @@ static const int NFlx = 6;
   TPad *Pad[6] = {nullptr};
   TGraphErrors *gr[6] = {nullptr};
   OnlMonDB *dbvars[NFlx] = {nullptr};
+  int m_FullHitmap = 0;
 
 
  
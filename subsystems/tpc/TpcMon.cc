@@ -8,6 +8,7 @@
 #include <onlmon/OnlMon.h>  // for OnlMon
 #include <onlmon/OnlMonDB.h>
 #include <onlmon/OnlMonServer.h>
+#include <onlmon/slidingMax.h>
 
 #include <Event/Event.h>
 #include <Event/msg_profile.h>
@@ -21,7 +22,10 @@
 #include <TTree.h>
 #include <TLatex.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <thread>
 #include <vector>
 #include <cstdio>  // for printf
 #include <fstream>
@@ -54,6 +58,15 @@ TpcMon::TpcMon(const std::string &name)
 TpcMon::~TpcMon()
 {
   // you can delete NULL pointers it results in a NOOP (No Operation)
+  StopThreads();
+  return;
+}
+
+void TpcMon::Threads(const int n)
+{
+  // the pool and the workers are set up again with the next event
+  StopThreads();
+  m_NThreads = (n > 0) ? n : 1;
   return;
 }
 
@@ -278,9 +291,23 @@ int TpcMon::Init()
   MAXADC_1D_R3->SetLineColor(4);
   RAWADC_1D_R3->SetLineColor(4);
 
+  // running pedestal and noise of every channel from the pre-samples
+  char PEDESTAL_str[100];
+  sprintf(PEDESTAL_str,"Pedestal vs FEE*256 + Channel: SECTOR %i",MonitorServerId());
+  PEDESTAL_CHANNEL = new TH1F("PEDESTAL_CHANNEL", PEDESTAL_str, N_FEE*N_CHANNEL, -0.5, N_FEE*N_CHANNEL - 0.5);
+  PEDESTAL_CHANNEL->SetXTitle("FEE_NUM*256 + CHANNEL");
+  PEDESTAL_CHANNEL->SetYTitle("Pedestal [ADU]");
+  char NOISE_str[100];
+  sprintf(NOISE_str,"Noise vs FEE*256 + Channel: SECTOR %i",MonitorServerId());
+  NOISE_CHANNEL = new TH1F("NOISE_CHANNEL", NOISE_str, N_FEE*N_CHANNEL, -0.5, N_FEE*N_CHANNEL - 0.5);
+  NOISE_CHANNEL->SetXTitle("FEE_NUM*256 + CHANNEL");
+  NOISE_CHANNEL->SetYTitle("Pedestal RMS [ADU]");
+
   OnlMonServer *se = OnlMonServer::instance();
   // register histograms with server otherwise client won't get them
   se->registerHisto(this, tpchist1);  // uses the TH1->GetName() as key
+  se->registerHisto(this, PEDESTAL_CHANNEL);
+  se->registerHisto(this, NOISE_CHANNEL);
   se->registerHisto(this, tpchist2);
   se->registerHisto(this, NorthSideADC);
   se->registerHisto(this, SouthSideADC);
@@ -319,11 +346,102 @@ int TpcMon::Init()
   se->registerHisto(this, NorthSideADC_clusterZY_unw);
   se->registerHisto(this, SouthSideADC_clusterZY_unw);
 
+  BuildPadMap();
 
   Reset();
   return 0;
 }
 
+void TpcMon::BuildPadMap()
+{
+  // clockwise FEE mapping
+  //int FEE_map[26]={5, 6, 1, 3, 2, 12, 10, 11, 9, 8, 7, 1, 2, 4, 8, 7, 6, 5, 4, 3, 1, 3, 2, 4, 6, 5};
+  int FEE_R[26]={2, 2, 1, 1, 1, 3, 3, 3, 3, 3, 3, 2, 2, 1, 2, 2, 1, 1, 2, 2, 3, 3, 3, 3, 3, 3};
+  // counter clockwise FEE mapping (From Takao - DEPRECATED AS OF 08.29)
+  //int FEE_map[26]={3, 2, 5, 3, 4, 0, 2, 1, 3, 4, 5, 7, 6, 2, 0, 1, 0, 1, 4, 5, 11, 9, 10, 8, 6, 7};
+
+  // FEE mapping from Jin
+  int FEE_map[26]={4, 5, 0, 2, 1, 11, 9, 10, 8, 7, 6, 0, 1, 3, 7, 6, 5, 4, 3, 2, 0, 2, 1, 3, 5, 4};
+
+  serverid = MonitorServerId();
+  TH2 *xy[3] = {NorthSideADC_clusterXY_R1, NorthSideADC_clusterXY_R2, NorthSideADC_clusterXY_R3};
+  TH2 *xy_unw[3] = {NorthSideADC_clusterXY_R1_unw, NorthSideADC_clusterXY_R2_unw, NorthSideADC_clusterXY_R3_unw};
+  TH2 *zy = NorthSideADC_clusterZY;
+  TH2 *zy_unw = NorthSideADC_clusterZY_unw;
+  if (side(serverid))
+  {
+    xy[0] = SouthSideADC_clusterXY_R1;
+    xy[1] = SouthSideADC_clusterXY_R2;
+    xy[2] = SouthSideADC_clusterXY_R3;
+    xy_unw[0] = SouthSideADC_clusterXY_R1_unw;
+    xy_unw[1] = SouthSideADC_clusterXY_R2_unw;
+    xy_unw[2] = SouthSideADC_clusterXY_R3_unw;
+    zy = SouthSideADC_clusterZY;
+    zy_unw = SouthSideADC_clusterZY_unw;
+  }
+  for (int fee = 0; fee < N_FEE; fee++)
+  {
+    // setting the mapp of the FEE
+    int feeM = FEE_map[fee];
+    if(FEE_R[fee]==2) feeM += 6;
+    if(FEE_R[fee]==3) feeM += 14;
+    int module = Module_ID(fee);
+    for (int channel = 0; channel < N_CHANNEL; channel++)
+    {
+      PadInfo &pad = padmap[fee][channel];
+      pad.module = module;
+      pad.sideindex = Index_from_Module(serverid, fee);
+      if (side(serverid))
+      {
+        pad.sideindex -= 36;
+      }
+      // getting R and Phi coordinates
+      pad.R = M.getR(feeM, channel);
+      pad.layer = M.getLayer(feeM, channel);
+      if( side(serverid) == 0 ) //NS
+      {
+        pad.phi = M.getPhi(feeM, channel) + (serverid ) * M_PI / 6 ;
+      }
+      else //SS
+      {
+        pad.phi = M.getPhi(feeM, channel) + (18 - serverid ) * M_PI / 6 ;
+      }
+      double x = pad.R * cos(pad.phi);
+      double y = pad.R * sin(pad.phi);
+      // the XY maps of all modules have the same binning, so do the ZY maps
+      pad.xybin = xy[module]->FindBin(x, y);
+      pad.zyybin = zy->GetYaxis()->FindBin(y);
+    }
+  }
+  // this is what Fill() with weights does on the first fill
+  for (int i = 0; i < 3; i++)
+  {
+    xy[i]->Sumw2();
+  }
+  zy->Sumw2();
+
+  m_FillHisto[FILL_CHECKSUMS] = Check_Sums;
+  m_FillHisto[FILL_CHECKSUMERROR] = Check_Sum_Error;
+  m_FillHisto[FILL_SAMPLESIZE] = sample_size_hist;
+  m_FillHisto[FILL_ADCSAMPLE] = ADC_vs_SAMPLE;
+  m_FillHisto[FILL_ADCSAMPLELARGE] = ADC_vs_SAMPLE_large;
+  m_FillHisto[FILL_RAWADC1D] = RAWADC_1D_R1;
+  m_FillHisto[FILL_RAWADC1D + 1] = RAWADC_1D_R2;
+  m_FillHisto[FILL_RAWADC1D + 2] = RAWADC_1D_R3;
+  m_FillHisto[FILL_MAXADC] = MAXADC;
+  m_FillHisto[FILL_MAXADC1D] = MAXADC_1D_R1;
+  m_FillHisto[FILL_MAXADC1D + 1] = MAXADC_1D_R2;
+  m_FillHisto[FILL_MAXADC1D + 2] = MAXADC_1D_R3;
+  for (int i = 0; i < 3; i++)
+  {
+    m_FillHisto[FILL_XY + i] = xy[i];
+    m_FillHisto[FILL_XYUNW + i] = xy_unw[i];
+  }
+  m_FillHisto[FILL_ZY] = zy;
+  m_FillHisto[FILL_ZYUNW] = zy_unw;
+  return;
+}
+
 int TpcMon::BeginRun(const int /* runno */)
 {
   // if you need to read calibrations on a run by run basis
@@ -354,14 +472,6 @@ int TpcMon::process_event(Event *evt/* evt */)
     return -1;
   }
 
-  //reset these each event
-  float North_Side_Arr[36] = {0};
-  float South_Side_Arr[36] = {0};
-
-  std::vector<int> store_ten; 
-  std::vector<int> mean_and_stdev_vec;
-
-
   // we check if we have legacy data and start with packet 4000
   // the range for the TPC is really 4001...4032
   // we assume we start properly at 4001, but check if not
@@ -384,221 +494,426 @@ int TpcMon::process_event(Event *evt/* evt */)
       //std::cout << "TpcMon::process_event - No packet numbered " << packet << " in this event!!" << std::endl;
       continue;
     }
-    else
-    {
-      //std::cout << "____________________________________" << std::endl;
-      //std::cout << "Packet # " << packet << std::endl;
-      int nr_of_waveforms = p->iValue(0, "NR_WF");
-      //std::cout << "Hello Waveforms ! - There are " << nr_of_waveforms << " of you !" << std::endl;
+    //std::cout << "____________________________________" << std::endl;
+    //std::cout << "Packet # " << packet << std::endl;
+    int nr_of_waveforms = p->iValue(0, "NR_WF");
+    //std::cout << "Hello Waveforms ! - There are " << nr_of_waveforms << " of you !" << std::endl;
+
+    UpdateBCO(p, nr_of_waveforms);
+    Decode(p, nr_of_waveforms);
+    delete p;
+  } //packet loop
 
-      bool is_channel_stuck = 0;
+  FillEvent();
+  return 0;
+}
 
-      for( int wf = 0; wf < nr_of_waveforms; wf++)
-      {
+void TpcMon::FillEvent()
+{
+  //reset these each event
+  float North_Side_Arr[36] = {0};
+  float South_Side_Arr[36] = {0};
 
-        int current_BCO = p->iValue(wf, "BCO") + rollover_value;
-        if (starting_BCO < 0)
-        {
-          starting_BCO = current_BCO;
-        }
+  ProcessEventWaveforms(North_Side_Arr, South_Side_Arr);
+  m_Waveforms.Clear();
 
-        if (current_BCO < starting_BCO)  // we have a rollover
-        {
-          rollover_value += 0x100000;
-          current_BCO = p->iValue(wf, "BCO") + rollover_value;
-          starting_BCO = current_BCO;
-          current_BCOBIN++;
-        }
+  evtcnt++;
 
+  // get temporary pointers to histograms
+  // one can do in principle directly se->getHisto("tpchist1")->Fill()
+  // but the search in the histogram Map is somewhat expensive and slows
+  // things down if you make more than one operation on a histogram
+  tpchist1->Fill((float) idummy);
+  tpchist2->Fill((float) idummy, (float) idummy, 1.);
 
-        int fee = p->iValue(wf, "FEE");
-        int sampaAddress = p->iValue(wf, "SAMPAADDRESS");
-        int checksumError = p->iValue(wf, "CHECKSUMERROR");
-        int channel = p->iValue(wf, "CHANNEL");
+  //fill the TPC module displays
+  float r, theta;
 
-        Check_Sums->Fill(fee*8 + sampaAddress); 
-        if( checksumError == 1){Check_Sum_Error->Fill(fee*8 + sampaAddress);}
+  //dummy data
+  //float North_Side_Arr[36] = { 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50 };
+  //float South_Side_Arr[36] = { 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50 };
 
-        int nr_Samples = p->iValue(wf, "SAMPLES");
-        sample_size_hist->Fill(nr_Samples);
+  for(int tpciter = 1; tpciter < 73 ; tpciter++){
 
+    Locate(tpciter, &r, &theta);
+    //std::cout << "r is: "<< r <<" theta is: "<< theta <<"\n";
+    if(tpciter < 37){ //South side
+      NorthSideADC->Fill(theta,r, North_Side_Arr[tpciter-1]); //fill South side with the weight = bin content
+    }
+    else { //North side
+      SouthSideADC->Fill(theta,r,South_Side_Arr[tpciter-37]); //fill North side with the weight = bin content
+    }
+  }
+  //
 
-        // clockwise FEE mapping
-        //int FEE_map[26]={5, 6, 1, 3, 2, 12, 10, 11, 9, 8, 7, 1, 2, 4, 8, 7, 6, 5, 4, 3, 1, 3, 2, 4, 6, 5};
-        int FEE_R[26]={2, 2, 1, 1, 1, 3, 3, 3, 3, 3, 3, 2, 2, 1, 2, 2, 1, 1, 2, 2, 3, 3, 3, 3, 3, 3};
-        // counter clockwise FEE mapping (From Takao - DEPRECATED AS OF 08.29)
-        //int FEE_map[26]={3, 2, 5, 3, 4, 0, 2, 1, 3, 4, 5, 7, 6, 2, 0, 1, 0, 1, 4, 5, 11, 9, 10, 8, 6, 7};
+  return;
+}
 
-        // FEE mapping from Jin
-        int FEE_map[26]={4, 5, 0, 2, 1, 11, 9, 10, 8, 7, 6, 0, 1, 3, 7, 6, 5, 4, 3, 2, 0, 2, 1, 3, 5, 4};
+void TpcMon::UpdateBCO(Packet *p, const int nr_of_waveforms)
+{
+  // the BCO rollover depends on the order of the waveforms, so it is kept out of the threads
+  for( int wf = 0; wf < nr_of_waveforms; wf++)
+  {
+    int current_BCO = p->iValue(wf, "BCO") + rollover_value;
+    if (starting_BCO < 0)
+    {
+      starting_BCO = current_BCO;
+    }
 
-        
-        //int pads_per_sector[3] = {96, 128, 192};
+    if (current_BCO < starting_BCO)  // we have a rollover
+    {
+      rollover_value += 0x100000;
+      current_BCO = p->iValue(wf, "BCO") + rollover_value;
+      starting_BCO = current_BCO;
+      current_BCOBIN++;
+    }
+  }
+  return;
+}
 
+void TpcMon::Decode(Packet *p, const int nr_of_waveforms)
+{
+  // the threads only see these copies, Packet::iValue is not meant to be called concurrently
+  for( int wf = 0; wf < nr_of_waveforms; wf++)
+  {
+    m_Waveforms.fee.push_back(p->iValue(wf, "FEE"));
+    m_Waveforms.sampaaddress.push_back(p->iValue(wf, "SAMPAADDRESS"));
+    m_Waveforms.checksumerror.push_back(p->iValue(wf, "CHECKSUMERROR"));
+    m_Waveforms.channel.push_back(p->iValue(wf, "CHANNEL"));
+    int nr_Samples = p->iValue(wf, "SAMPLES");
+    m_Waveforms.nsamples.push_back(nr_Samples);
+    m_Waveforms.first.push_back(m_Waveforms.adc.size());
+    for( int s =0; s < nr_Samples ; s++ )
+    {
+      m_Waveforms.adc.push_back(p->iValue(wf,s));
+    }
+  }
+  return;
+}
 
-        serverid = MonitorServerId();
+void TpcMon::ProcessEventWaveforms(float *North_Side_Arr, float *South_Side_Arr)
+{
+  if (m_Workers.size() != static_cast<unsigned int>(m_NThreads))
+  {
+    // the bin sums of a worker cover all bins of the histograms it fills
+    m_Workers.clear();
+    for (int i = 0; i < m_NThreads; i++)
+    {
+      m_Workers.emplace_back(new Worker());
+      for (int ih = 0; ih < N_FILLHISTO; ih++)
+      {
+        BinSums &sums = m_Workers.back()->sums[ih];
+        sums.sumw.assign(m_FillHisto[ih]->GetNcells(), 0);
+        sums.used.assign(m_FillHisto[ih]->GetNcells(), 0);
+        if (m_FillHisto[ih]->GetSumw2N())
+        {
+          sums.sumw2.assign(m_FillHisto[ih]->GetNcells(), 0);
+        }
+      }
+    }
+  }
+  if (m_Threads.empty())
+  {
+    m_ThreadEvent = 0;
+    for (int i = 1; i < m_NThreads; i++)
+    {
+      m_Threads.emplace_back(&TpcMon::ThreadLoop, this, i);
+    }
+  }
 
-        // setting the mapp of the FEE
-        int feeM = FEE_map[fee];
-        if(FEE_R[fee]==2) feeM += 6;
-        if(FEE_R[fee]==3) feeM += 14;
+  m_NextChunk = 0;
+  if (!m_Threads.empty())
+  {
+    std::lock_guard<std::mutex> lock(m_ThreadMutex);
+    m_ThreadEvent++;
+    m_ThreadsBusy = m_Threads.size();
+  }
+  m_ThreadWake.notify_all();
+  ProcessChunks(*m_Workers[0]);
+  if (!m_Threads.empty())
+  {
+    std::unique_lock<std::mutex> lock(m_ThreadMutex);
+    m_ThreadDone.wait(lock, [this]
+                      { return m_ThreadsBusy == 0; });
+  }
 
-        // getting R and Phi coordinates
-        double R = M.getR(feeM, channel);
-        int layer = M.getLayer(feeM, channel);
-        double phi = 0;
+  // the chunks go to whichever thread is free, all sums are integers so
+  // the histograms do not depend on it
+  for (auto &worker : m_Workers)
+  {
+    MergeWorker(*worker, North_Side_Arr, South_Side_Arr);
+  }
+  return;
+}
 
-        //double phi = M.getPhi(feeM, channel) + (serverid - 12*side(serverid)) * M_PI / 6 ;
+void TpcMon::ThreadLoop(const int iworker)
+{
+  unsigned long done = 0;  // the last event of this thread, the pool starts at 0
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_ThreadMutex);
+      m_ThreadWake.wait(lock, [this, done]
+                        { return m_ThreadsStop || m_ThreadEvent != done; });
+      if (m_ThreadsStop)
+      {
+        return;
+      }
+      done = m_ThreadEvent;
+    }
+    ProcessChunks(*m_Workers[iworker]);
+    {
+      std::lock_guard<std::mutex> lock(m_ThreadMutex);
+      m_ThreadsBusy--;
+    }
+    m_ThreadDone.notify_one();
+  }
+}
 
-        if( side(serverid) == 0 ) //NS
-        {
-          phi = M.getPhi(feeM, channel) + (serverid ) * M_PI / 6 ; 
-        }
-        else if( side(serverid) == 1 ) //SS
-        {
-          phi = M.getPhi(feeM, channel) + (18 - serverid ) * M_PI / 6 ; 
-        }
+void TpcMon::StopThreads()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_ThreadMutex);
+    m_ThreadsStop = true;
+  }
+  m_ThreadWake.notify_all();
+  for (auto &thread : m_Threads)
+  {
+    thread.join();
+  }
+  m_Threads.clear();
+  m_ThreadsStop = false;
+  return;
+}
 
+void TpcMon::ProcessChunks(Worker &worker)
+{
+  int nwf = m_Waveforms.fee.size();
+  for (int wf = WFCHUNK * m_NextChunk++; wf < nwf; wf = WFCHUNK * m_NextChunk++)
+  {
+    ProcessWaveforms(worker, wf, std::min(wf + WFCHUNK, nwf));
+  }
+  return;
+}
 
-        //std::cout<<"Sector = "<< serverid <<" FEE = "<<fee<<" channel = "<<channel<<std::endl;
+void TpcMon::ProcessWaveforms(Worker &worker, const int wfbegin, const int wfend)
+{
+  // all fills go into the worker, the histograms and pedacc are only read
+  // here, they are not modified before all threads are done with the event
+  slidingMax store_ten(10); // max of the last 10 samples
+  BinSums *sums = worker.sums;
 
-        int mid = floor(nr_Samples/2); //get median sample
+  for( int wf = wfbegin; wf < wfend; wf++)
+  {
+    int fee = m_Waveforms.fee[wf];
+    int sampaAddress = m_Waveforms.sampaaddress[wf];
+    int checksumError = m_Waveforms.checksumerror[wf];
+    int channel = m_Waveforms.channel[wf];
 
-        if( nr_Samples > 9)
-        {
-          if( (p->iValue(wf,mid) == p->iValue(wf,mid-1)) && (p->iValue(wf,mid) == p->iValue(wf,mid-2)) && (p->iValue(wf,mid) == p->iValue(wf,mid+1)) && (p->iValue(wf,mid) == p->iValue(wf,mid+2)) )     
-          {
-            is_channel_stuck = 1;
-          }
-          for( int si=0;si < 10; si++ ) //get pedestal and noise before hand
-          {
-            mean_and_stdev_vec.push_back(p->iValue(wf,si));
-          }
-        } //Compare 5 values to determine stuck !!
-
-        std::pair<float, float> result = calculateMeanAndStdDev(mean_and_stdev_vec);
-        int pedestal = result.first; //average/pedestal
-        //int noise = result.second; //stdev/noise
-
-        int wf_max = 0;
-        int t_max = 0;
-
-        for( int s =0; s < nr_Samples ; s++ )
-        {
-          
-          //int t = s + 2 * (current_BCO - starting_BCO);
+    sums[FILL_CHECKSUMS].Fill(Check_Sums->FindFixBin(fee*8 + sampaAddress), 1.);
+    if( checksumError == 1){sums[FILL_CHECKSUMERROR].Fill(Check_Sum_Error->FindFixBin(fee*8 + sampaAddress), 1.);}
+
+    int nr_Samples = m_Waveforms.nsamples[wf];
+    sums[FILL_SAMPLESIZE].Fill(sample_size_hist->FindFixBin(nr_Samples), 1.);
+
+
+    if (fee < 0 || fee >= N_FEE || channel < 0 || channel >= N_CHANNEL)
+    {
+      continue;
+    }
+    const PadInfo &pad = padmap[fee][channel];
 
-          int adc = p->iValue(wf,s);       
+    //std::cout<<"Sector = "<< serverid <<" FEE = "<<fee<<" channel = "<<channel<<std::endl;
 
-          if( adc > wf_max){ wf_max = adc; t_max = s; }
+    const int *adcs = m_Waveforms.adc.data() + m_Waveforms.first[wf];
 
-          if( s >= 10 && s <= 19) // get first 10-19
-          {
-            store_ten.push_back(adc);
-          }
-          else if( s > 19 )  
-          {
+    int mid = floor(nr_Samples/2); //get median sample
 
-            //nine_max = Max_Nine(p->iValue(wf,s-9),p->iValue(wf,s-8),p->iValue(wf,s-7),p->iValue(wf,s-6),p->iValue(wf,s-5),p->iValue(wf,s-4),p->iValue(wf,s-3),p->iValue(wf,s-2),p->iValue(wf,s-1)); //take the previous 9 numbers
+    bool is_channel_stuck = 0;
+    if( nr_Samples > 9)
+    {
+      if( (adcs[mid] == adcs[mid-1]) && (adcs[mid] == adcs[mid-2]) && (adcs[mid] == adcs[mid+1]) && (adcs[mid] == adcs[mid+2]) )     
+      {
+        is_channel_stuck = 1;
+      }
+    } //Compare 5 values to determine stuck !!
 
-            //VERY IMPORTANT, erase first entry, push_back current
-            store_ten.erase(store_ten.begin());
-            store_ten.push_back(adc);
-             
-            int max_of_previous_10 = *max_element(store_ten.begin(), store_ten.end());
+    int pedestal = 0;
+    if( nr_Samples > 9)
+    {
+      PedestalAccumulator wfacc;
+      float sum = 0;
+      for( int si=0;si < 10; si++ ) //get pedestal and noise before hand
+      {
+        sum += adcs[si];
+        wfacc.Add(adcs[si]);
+      }
+      pedestal = sum / 10; //average/pedestal
+      if( checksumError == 0 )
+      {
+        PedestalAccumulator &chanacc = worker.pedestal[fee][channel];
+        if (chanacc.n == 0)
+        {
+          worker.pedestalchannels.push_back(fee*N_CHANNEL + channel);
+        }
+        chanacc.Add(wfacc);
+      }
+      // the running pedestal of the channel is more stable than the one of this waveform
+      const PedestalAccumulator &acc = pedacc[fee][channel];
+      if( m_PedestalWarmup > 0 && acc.n >= m_PedestalWarmup ) {pedestal = acc.Mean();}
+    }
 
-            if(adc == max_of_previous_10 && (checksumError == 0 && is_channel_stuck == 0)) //if the new value is greater than the previous 9
-            {
-               MAXADC->Fill(adc - pedestal,Module_ID(fee)); 
-               if(Module_ID(fee)==0){MAXADC_1D_R1->Fill(adc - pedestal);} //Raw 1D for R1
-               else if(Module_ID(fee)==1){MAXADC_1D_R2->Fill(adc - pedestal);} //Raw 1D for R2
-               else if(Module_ID(fee)==2){MAXADC_1D_R3->Fill(adc - pedestal);} //Raw 1D for R3
-            }
+    // branch free so the compiler can vectorize it
+    int wf_max = 0;
+    for( int s =0; s < nr_Samples ; s++ )
+    {
+      wf_max = std::max(wf_max, adcs[s]);
+    }
 
-          }
+    auto fillraw = [&](const int s, const int adc)
+    {
+      if( checksumError == 0 && is_channel_stuck == 0)
+      {
+        sums[FILL_ADCSAMPLE].Fill(ADC_vs_SAMPLE->FindFixBin(s, adc), 1.);
+        sums[FILL_ADCSAMPLELARGE].Fill(ADC_vs_SAMPLE_large->FindFixBin(s, adc), 1.);
 
-          if( checksumError == 0 && is_channel_stuck == 0)
-          {
-            ADC_vs_SAMPLE -> Fill(s, adc);
-            ADC_vs_SAMPLE_large -> Fill(s, adc);
+        // Raw 1D for R1, R2, R3, all of them have the same binning
+        sums[FILL_RAWADC1D + pad.module].Fill(RAWADC_1D_R1->FindFixBin(adc), 1.);
+      }
 
-            if(Module_ID(fee)==0){RAWADC_1D_R1->Fill(adc);} //Raw 1D for R1
-            else if(Module_ID(fee)==1){RAWADC_1D_R2->Fill(adc);} //Raw 1D for R2
-            else if(Module_ID(fee)==2){RAWADC_1D_R3->Fill(adc);} //Raw 1D for R3
-          }
+      //increment 
+      if(serverid >= 0 && serverid < 12 ){ worker.North_Side_Arr[ pad.sideindex ] += adc;}
+      else {worker.South_Side_Arr[ pad.sideindex ] += adc;}
+    };
 
-          //increment 
-          if(serverid >= 0 && serverid < 12 ){ North_Side_Arr[ Index_from_Module(serverid,fee) ] += adc;}
-          else {South_Side_Arr[ Index_from_Module(serverid,fee)-36 ] += adc;}
+    if( m_PulseThreshold > 0 && (wf_max - pedestal) <= m_PulseThreshold )
+    {
+      // only noise, no peak search and no hit, the raw adc histograms still get it
+      for( int s =0; s < nr_Samples ; s++ )
+      {
+        fillraw(s, adcs[s]);
+      }
+      continue;
+    }
 
-        } //nr samples
+    // first sample at the maximum
+    int t_max = (wf_max > 0) ? std::find(adcs, adcs + nr_Samples, wf_max) - adcs : 0;
 
-        //for complicated XY stuff ____________________________________________________
-        //20 = 3-5 * sigma - hard-coded
-        // OR 10*noise = 10 sigma
+    for( int s =0; s < nr_Samples ; s++ )
+    {
+      
+      //int t = s + 2 * (current_BCO - starting_BCO);
 
-        float z = 0; //mm
+      int adc = adcs[s];       
 
-        if( (serverid < 12 && (wf_max - pedestal) > 20) && layer != 0 )
-        {
-          if(Module_ID(fee)==0){NorthSideADC_clusterXY_R1->Fill(R*cos(phi),R*sin(phi),wf_max - pedestal);NorthSideADC_clusterXY_R1_unw->Fill(R*cos(phi),R*sin(phi));} //Raw 1D for R1
-          else if(Module_ID(fee)==1){NorthSideADC_clusterXY_R2->Fill(R*cos(phi),R*sin(phi),wf_max - pedestal);NorthSideADC_clusterXY_R2_unw->Fill(R*cos(phi),R*sin(phi));} //Raw 1D for R2
-          else if(Module_ID(fee)==2){NorthSideADC_clusterXY_R3->Fill(R*cos(phi),R*sin(phi),wf_max - pedestal);NorthSideADC_clusterXY_R3_unw->Fill(R*cos(phi),R*sin(phi));} //Raw 1D for R3
+      if( s >= 10 && s <= 19) // get first 10-19
+      {
+        store_ten.Add(adc);
+      }
+      else if( s > 19 )  
+      {
 
-          if( t_max >= 10 && t_max <=255 ){z = 1030 - (t_max - 10)*(50 * 0.084);NorthSideADC_clusterZY->Fill(z,R*sin(phi),wf_max - pedestal);NorthSideADC_clusterZY_unw->Fill(z,R*sin(phi));}
-        }
-        else if( (serverid >=12 && (wf_max - pedestal) > 20) && layer != 0)
-        {
-          if(Module_ID(fee)==0){SouthSideADC_clusterXY_R1->Fill(R*cos(phi),R*sin(phi),wf_max - pedestal);SouthSideADC_clusterXY_R1_unw->Fill(R*cos(phi),R*sin(phi));} //Raw 1D for R1
-          else if(Module_ID(fee)==1){SouthSideADC_clusterXY_R2->Fill(R*cos(phi),R*sin(phi),wf_max - pedestal);SouthSideADC_clusterXY_R2_unw->Fill(R*cos(phi),R*sin(phi));} //Raw 1D for R2
-          else if(Module_ID(fee)==2){SouthSideADC_clusterXY_R3->Fill(R*cos(phi),R*sin(phi),wf_max - pedestal);SouthSideADC_clusterXY_R3_unw->Fill(R*cos(phi),R*sin(phi));} //Raw 1D for R3
+        //nine_max = Max_Nine(p->iValue(wf,s-9),p->iValue(wf,s-8),p->iValue(wf,s-7),p->iValue(wf,s-6),p->iValue(wf,s-5),p->iValue(wf,s-4),p->iValue(wf,s-3),p->iValue(wf,s-2),p->iValue(wf,s-1)); //take the previous 9 numbers
+
+        //window of the samples s-9 ... s
+        int max_of_previous_10 = store_ten.Add(adc);
 
-          if( t_max >= 10 && t_max <=255 ){z = -1030 + (t_max - 10)*(50 * 0.084);SouthSideADC_clusterZY->Fill(z,R*sin(phi),wf_max - pedestal);SouthSideADC_clusterZY_unw->Fill(z,R*sin(phi));}
+        if(adc == max_of_previous_10 && (checksumError == 0 && is_channel_stuck == 0)) //if the new value is greater than the previous 9
+        {
+           sums[FILL_MAXADC].Fill(MAXADC->FindFixBin(adc - pedestal,pad.module), 1.); 
+           sums[FILL_MAXADC1D + pad.module].Fill(MAXADC_1D_R1->FindFixBin(adc - pedestal), 1.); // 1D for R1, R2, R3
         }
-        //________________________________________________________________________________
 
-        is_channel_stuck = 0; //reset after looping through waveform samples
+      }
 
-        store_ten.clear(); //clear this after every waveform
-        
-        mean_and_stdev_vec.clear(); //clear this after every waveform
+      fillraw(s, adc);
 
+    } //nr samples
 
-      } //nr waveforms
-      delete p;
-    }
-  } //packet loop
+    //for complicated XY stuff ____________________________________________________
+    //20 = 3-5 * sigma - hard-coded
+    // OR 10*noise = 10 sigma
 
-  evtcnt++;
+    float z = 0; //mm
 
-  // get temporary pointers to histograms
-  // one can do in principle directly se->getHisto("tpchist1")->Fill()
-  // but the search in the histogram Map is somewhat expensive and slows
-  // things down if you make more than one operation on a histogram
-  tpchist1->Fill((float) idummy);
-  tpchist2->Fill((float) idummy, (float) idummy, 1.);
+    // bins from the pad map, both sides fill their own histograms
+    if( (wf_max - pedestal) > 20 && pad.layer != 0 )
+    {
+      sums[FILL_XY + pad.module].Fill(pad.xybin, wf_max - pedestal);
+      sums[FILL_XYUNW + pad.module].Fill(pad.xybin, 1.);
 
-  //fill the TPC module displays
-  float r, theta;
+      if( t_max >= 10 && t_max <=255 )
+      {
+        if (serverid < 12) {z = 1030 - (t_max - 10)*(50 * 0.084);}
+        else {z = -1030 + (t_max - 10)*(50 * 0.084);}
+        TH1 *zy = m_FillHisto[FILL_ZY];
+        int zybin = zy->GetBin(zy->GetXaxis()->FindFixBin(z), pad.zyybin);
+        sums[FILL_ZY].Fill(zybin, wf_max - pedestal);
+        sums[FILL_ZYUNW].Fill(zybin, 1.);
+      }
+    }
+    //________________________________________________________________________________
 
-  //dummy data
-  //float North_Side_Arr[36] = { 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50 };
-  //float South_Side_Arr[36] = { 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50, 12, 8, 40, 39, 80, 50 };
+    store_ten.Reset(); //clear this after every waveform
 
-  for(int tpciter = 1; tpciter < 73 ; tpciter++){
+  } //nr waveforms
+  return;
+}
 
-    Locate(tpciter, &r, &theta);
-    //std::cout << "r is: "<< r <<" theta is: "<< theta <<"\n";
-    if(tpciter < 37){ //South side
-      NorthSideADC->Fill(theta,r, North_Side_Arr[tpciter-1]); //fill South side with the weight = bin content
+void TpcMon::MergeWorker(Worker &worker, float *North_Side_Arr, float *South_Side_Arr)
+{
+  for (int ih = 0; ih < N_FILLHISTO; ih++)
+  {
+    TH1 *h = m_FillHisto[ih];
+    BinSums &sums = worker.sums[ih];
+    for (int bin : sums.bins)
+    {
+      // what Fill() does after the bin is found, the statistics are then calculated from the bin contents
+      h->AddBinContent(bin, sums.sumw[bin]);
+      sums.sumw[bin] = 0;
+      if (!sums.sumw2.empty())
+      {
+        h->GetSumw2()->fArray[bin] += sums.sumw2[bin];
+        sums.sumw2[bin] = 0;
+      }
+      sums.used[bin] = 0;
     }
-    else { //North side
-      SouthSideADC->Fill(theta,r,South_Side_Arr[tpciter-37]); //fill North side with the weight = bin content
+    if (sums.entries > 0)
+    {
+      h->SetEntries(h->GetEntries() + sums.entries);
     }
+    sums.bins.clear();
+    sums.entries = 0;
   }
-  //
-
-  return 0;
+  for (int index : worker.pedestalchannels)
+  {
+    int fee = index / N_CHANNEL;
+    int channel = index % N_CHANNEL;
+    PedestalAccumulator &chanacc = pedacc[fee][channel];
+    if (chanacc.n == 0)
+    {
+      m_PedestalChannels++;
+    }
+    chanacc.Add(worker.pedestal[fee][channel]);
+    worker.pedestal[fee][channel] = PedestalAccumulator();
+    PEDESTAL_CHANNEL->SetBinContent(index + 1, chanacc.Mean());
+    NOISE_CHANNEL->SetBinContent(index + 1, chanacc.RMS());
+  }
+  // SetBinContent counts an entry for every update, one entry per channel instead
+  if (!worker.pedestalchannels.empty())
+  {
+    PEDESTAL_CHANNEL->SetEntries(m_PedestalChannels);
+    NOISE_CHANNEL->SetEntries(m_PedestalChannels);
+  }
+  worker.pedestalchannels.clear();
+  for (int j = 0; j < 36; j++)
+  {
+    North_Side_Arr[j] += worker.North_Side_Arr[j];
+    South_Side_Arr[j] += worker.South_Side_Arr[j];
+    worker.North_Side_Arr[j] = 0;
+    worker.South_Side_Arr[j] = 0;
+  }
+  return;
 }
 
 int TpcMon::Module_ID(int fee_id) //for simply determining which module you are in (doesn't care about sector)
@@ -681,33 +996,19 @@ bool TpcMon::side(int server_id)
   return side_id;
 }
 
-std::pair<float, float> TpcMon::calculateMeanAndStdDev(const std::vector<int>& values) {
-    // Calculate the mean
-    float sum = 0.0;
-    for (const auto& value : values) {
-        sum += value;
-    }
-    float mean = sum / values.size();
-
-    // Calculate the standard deviation
-    float squaredSum = 0.0;
-    for (const auto& value : values) {
-        double diff = value - mean;
-        squaredSum += diff * diff;
-    }
-    float variance = squaredSum / values.size();
-    float stdDev = std::sqrt(variance);
-
-    return std::make_pair(mean, stdDev);
-}
-
-
-
 int TpcMon::Reset()
 {
   // reset our internal counters
   evtcnt = 0;
   idummy = 0;
+  for (auto &feeacc : pedacc)
+  {
+    for (auto &acc : feeacc)
+    {
+      acc = PedestalAccumulator();
+    }
+  }
+  m_PedestalChannels = 0;
   return 0;
 }
 
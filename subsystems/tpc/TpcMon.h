@@ -3,15 +3,21 @@
 
 #include <onlmon/OnlMon.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <map>
 #include <tpc/TpcMap.h> //this needs to be pointed to coresoftware - not sure how to do that on EBDCXX...
 #include <memory>
+#include <mutex>
 #include <string>
 #include <cmath>
+#include <thread>
 #include <vector>
 
 
 class Event;
+class Packet;
 class TH1;
 class TH2;
 class TTree;
@@ -26,6 +32,12 @@ class TpcMon : public OnlMon
   int Init();
   int BeginRun(const int runno);
   int Reset();
+  // use the running pedestal of a channel once it saw this many pre-samples, 0: per waveform
+  void PedestalWarmup(const long n) { m_PedestalWarmup = n; }
+  // number of threads for the waveforms of an event, 1 (default) processes them in the event loop
+  void Threads(const int n);
+  // waveforms whose maximum is not more than this above pedestal only fill the raw adc histograms, 0: off
+  void PulseThreshold(const int adc) { m_PulseThreshold = adc; }
 
  protected:
   int evtcnt = 0;
@@ -97,18 +109,171 @@ class TpcMon : public OnlMon
 
   TpcMap M; //declare Martin's map
 
+  // geometry and histogram bins of each (fee, channel), filled in Init
+  static const int N_FEE = 26;
+  static const int N_CHANNEL = 256;
+  struct PadInfo
+  {
+    int module = 0;
+    int sideindex = 0;  // index in North/South_Side_Arr
+    int layer = 0;
+    double R = 0;
+    double phi = 0;
+    int xybin = 0;   // global bin in the xy maps of the module
+    int zyybin = 0;  // y bin in the zy maps
+  };
+  PadInfo padmap[N_FEE][N_CHANNEL];
+
+  // running mean and variance of the pre-samples of a channel, the adc values
+  // are integers so the sums are exact and do not depend on the order they are added in.
+  // sum2 overflows after some 10^12 samples, n * sum2 did after a few million,
+  // so the variance is taken in double
+  struct PedestalAccumulator
+  {
+    long n = 0;
+    long sum = 0;
+    long sum2 = 0;
+    void Add(const int adc)
+    {
+      n++;
+      sum += adc;
+      sum2 += static_cast<long>(adc) * adc;
+    }
+    void Add(const PedestalAccumulator &other)
+    {
+      n += other.n;
+      sum += other.sum;
+      sum2 += other.sum2;
+    }
+    double Mean() const { return (n > 0) ? static_cast<double>(sum) / n : 0; }
+    double RMS() const
+    {
+      if (n == 0)
+      {
+        return 0;
+      }
+      double mean = Mean();
+      return std::sqrt(std::max(0., static_cast<double>(sum2) / n - mean * mean));
+    }
+  };
+  PedestalAccumulator pedacc[N_FEE][N_CHANNEL];
+  long m_PedestalChannels = 0;  // channels with a pedestal, the entries of PEDESTAL/NOISE_CHANNEL
+  long m_PedestalWarmup = 0;
+  int m_PulseThreshold = 0;
+  TH1 *PEDESTAL_CHANNEL = nullptr;
+  TH1 *NOISE_CHANNEL = nullptr;
+
+  // the waveforms of the packets of an event, decoded in the event loop so
+  // the threads never call the packets
+  struct Waveforms
+  {
+    std::vector<int> fee;
+    std::vector<int> sampaaddress;
+    std::vector<int> checksumerror;
+    std::vector<int> channel;
+    std::vector<int> nsamples;
+    std::vector<long> first;  // index of the first sample in adc
+    std::vector<int> adc;
+    void Clear()
+    {
+      fee.clear();
+      sampaaddress.clear();
+      checksumerror.clear();
+      channel.clear();
+      nsamples.clear();
+      first.clear();
+      adc.clear();
+    }
+  };
+  Waveforms m_Waveforms;
+
+  // histograms filled from the waveforms, the xy and zy maps are the ones of the side of this server
+  enum
+  {
+    FILL_CHECKSUMS,
+    FILL_CHECKSUMERROR,
+    FILL_SAMPLESIZE,
+    FILL_ADCSAMPLE,
+    FILL_ADCSAMPLELARGE,
+    FILL_RAWADC1D,                 // R1, R2, R3
+    FILL_MAXADC = FILL_RAWADC1D + 3,
+    FILL_MAXADC1D,                 // R1, R2, R3
+    FILL_XY = FILL_MAXADC1D + 3,   // R1, R2, R3
+    FILL_XYUNW = FILL_XY + 3,      // R1, R2, R3
+    FILL_ZY = FILL_XYUNW + 3,
+    FILL_ZYUNW,
+    N_FILLHISTO
+  };
+  TH1 *m_FillHisto[N_FILLHISTO] = {nullptr};
+
+  // bin contents a thread added to one histogram since the last merge
+  struct BinSums
+  {
+    std::vector<double> sumw;
+    std::vector<double> sumw2;  // empty if the histogram has no sumw2
+    std::vector<char> used;
+    std::vector<int> bins;  // the bins which were filled
+    long entries = 0;
+    void Fill(const int bin, const double w)
+    {
+      if (!used[bin])
+      {
+        used[bin] = 1;
+        bins.push_back(bin);
+      }
+      sumw[bin] += w;
+      if (!sumw2.empty())
+      {
+        sumw2[bin] += w * w;
+      }
+      entries++;
+    }
+  };
+  // everything a thread fills, merged into the histograms after each event
+  struct Worker
+  {
+    BinSums sums[N_FILLHISTO];
+    PedestalAccumulator pedestal[N_FEE][N_CHANNEL];
+    std::vector<int> pedestalchannels;  // fee*N_CHANNEL + channel of the filled pedestals
+    double North_Side_Arr[36] = {0};
+    double South_Side_Arr[36] = {0};
+  };
+  std::vector<std::unique_ptr<Worker>> m_Workers;  // m_Workers[0] is the one of the event loop
+
+  // the m_NThreads - 1 threads of the pool are started with the first event and
+  // wait for the next one, the event loop processes chunks as well
+  static const int WFCHUNK = 64;
+  int m_NThreads = 1;
+  std::vector<std::thread> m_Threads;
+  std::mutex m_ThreadMutex;
+  std::condition_variable m_ThreadWake;
+  std::condition_variable m_ThreadDone;
+  unsigned long m_ThreadEvent = 0;
+  int m_ThreadsBusy = 0;
+  bool m_ThreadsStop = false;
+  std::atomic<int> m_NextChunk{0};
+
   int starting_BCO;
   int rollover_value;
   int current_BCOBIN;
 
   int serverid;
 
+  void BuildPadMap();
+  void UpdateBCO(Packet *p, const int nr_of_waveforms);
+  void Decode(Packet *p, const int nr_of_waveforms);
+  void FillEvent();
+  void ProcessEventWaveforms(float *North_Side_Arr, float *South_Side_Arr);
+  void ProcessChunks(Worker &worker);
+  void ProcessWaveforms(Worker &worker, const int wfbegin, const int wfend);
+  void MergeWorker(Worker &worker, float *North_Side_Arr, float *South_Side_Arr);
+  void ThreadLoop(const int iworker);
+  void StopThreads();
   void Locate(int id, float *rbin, float *thbin);
   int Index_from_Module(int sec_id, int fee_id);
   int Module_ID(int fee_id);
   int Max_Nine(int one, int two, int three, int four, int five, int six, int seven, int eight, int nine);
   bool side(int server_id);
-  std::pair<float, float> calculateMeanAndStdDev(const std::vector<int>& values);
 };
 
 #endif /* TPC_TPCMON_H */
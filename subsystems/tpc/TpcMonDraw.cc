@@ -40,6 +40,17 @@ TpcMonDraw::TpcMonDraw(const std::string &name)
 
 int TpcMonDraw::Init()
 {
+  OnlMonClient *cl = OnlMonClient::instance();
+  // the z-y views are merged on the client once per update instead of
+  // overlaying 24 histograms, servers 0-11 are the north side, 12-23 the south side
+  char TPCMON_STR[100];
+  for( int i=0; i<24; i++ )
+  {
+    sprintf(TPCMON_STR,"TPCMON_%i",i);
+    std::string side = (i < 12) ? "North" : "South";
+    cl->addMergeSource("TPCMON", "ADC_clusterZY", TPCMON_STR, side + "SideADC_clusterZY");
+    cl->addMergeSource("TPCMON", "ADC_clusterZY_unw", TPCMON_STR, side + "SideADC_clusterZY_unw");
+  }
   return 0;
 }
 
@@ -320,6 +331,63 @@ int TpcMonDraw::Draw(const std::string &what)
   return iret;
 }
 
+int TpcMonDraw::HistoVersions(const std::string &what, std::map<std::string, unsigned int> &versions)
+{
+  // histograms of the 24 servers each canvas is drawn from, FrameWorkVars has
+  // the run number and event time of the title. A server which went away
+  // changes the update count of its histograms, the dead server display is covered
+  static const std::map<std::string, std::vector<std::string>> canvashistos = {
+      {"TPCMODULE", {"NorthSideADC", "SouthSideADC"}},
+      {"TPCSAMPLESIZE", {"sample_size_hist"}},
+      {"TPCCHECKSUMERROR", {"Check_Sum_Error", "Check_Sums"}},
+      {"TPCADCVSSAMPLE", {"ADC_vs_SAMPLE"}},
+      {"TPCADCVSSAMPLELARGE", {"ADC_vs_SAMPLE_large"}},
+      {"TPCMAXADCMODULE", {"MAXADC"}},
+      {"TPCRAWADC1D", {"RAWADC_1D_R1", "RAWADC_1D_R2", "RAWADC_1D_R3"}},
+      {"TPCMAXADC1D", {"MAXADC_1D_R1", "MAXADC_1D_R2", "MAXADC_1D_R3"}},
+      {"TPCCLUSTERSXYWEIGTHED", {"NorthSideADC_clusterXY_R1", "NorthSideADC_clusterXY_R2", "NorthSideADC_clusterXY_R3", "SouthSideADC_clusterXY_R1", "SouthSideADC_clusterXY_R2", "SouthSideADC_clusterXY_R3"}},
+      {"TPCCLUSTERSXYUNWEIGTHED", {"NorthSideADC_clusterXY_R1_unw", "NorthSideADC_clusterXY_R2_unw", "NorthSideADC_clusterXY_R3_unw", "SouthSideADC_clusterXY_R1_unw", "SouthSideADC_clusterXY_R2_unw", "SouthSideADC_clusterXY_R3_unw"}},
+      {"TPCCLUSTERSZYWEIGTHED", {"NorthSideADC_clusterZY", "SouthSideADC_clusterZY"}},
+      {"TPCCLUSTERSZYUNWEIGTHED", {"NorthSideADC_clusterZY_unw", "SouthSideADC_clusterZY_unw"}}};
+  auto canvasiter = canvashistos.find(what);
+  if (canvasiter == canvashistos.end())
+  {
+    // FIRST, SECOND and ALL are not worth it
+    return -1;
+  }
+  OnlMonClient *cl = OnlMonClient::instance();
+  char TPCMON_STR[100];
+  for (int i = 0; i < 24; i++)
+  {
+    sprintf(TPCMON_STR, "TPCMON_%i", i);
+    for (auto &hname : canvasiter->second)
+    {
+      versions[std::string(TPCMON_STR) + ' ' + hname] = cl->HistoUpdates(TPCMON_STR, hname);
+      // the x-y overviews are not registered online, they come rebinned from the server
+      versions[std::string(TPCMON_STR) + ' ' + hname + " server"] = cl->ServerVersion(TPCMON_STR, hname);
+    }
+    versions[std::string(TPCMON_STR) + " FrameWorkVars"] = cl->HistoUpdates(TPCMON_STR, "FrameWorkVars");
+  }
+  versions["xy rebin"] = m_XYRebin;
+  return 0;
+}
+
+void TpcMonDraw::XYOverview(const std::string &monitor, const std::vector<std::string> &hnames, TH2 *histos[])
+{
+  OnlMonClient *cl = OnlMonClient::instance();
+  // the pads have fewer pixels than the 400x400 bins, the server combines
+  // XYRebin x XYRebin bins and only sends the maps which changed since the last draw.
+  // Histograms read from files are not on a server, they are shown as they are
+  std::vector<TH1 *> rebinned;
+  cl->requestHistosRebinned(monitor, hnames, m_XYRebin, m_XYRebin, 1, rebinned);
+  for (unsigned int i = 0; i < hnames.size(); i++)
+  {
+    TH1 *histo = (i < rebinned.size() && rebinned[i]) ? rebinned[i] : cl->getHisto(monitor, hnames[i]);
+    histos[i] = static_cast<TH2 *>(histo);
+  }
+  return;
+}
+
 int TpcMonDraw::DrawFirst(const std::string & /* what */)
 {
   OnlMonClient *cl = OnlMonClient::instance();
@@ -1030,13 +1098,13 @@ int TpcMonDraw::DrawTPCXYclusters(const std::string & /* what */)
   {
     //const TString TPCMON_STR( Form( "TPCMON_%i", i ) );
     sprintf(TPCMON_STR,"TPCMON_%i",i);
-    tpcmon_NSTPC_clusXY[i][0] = (TH2*) cl->getHisto(TPCMON_STR,"NorthSideADC_clusterXY_R1");
-    tpcmon_NSTPC_clusXY[i][1] = (TH2*) cl->getHisto(TPCMON_STR,"NorthSideADC_clusterXY_R2");
-    tpcmon_NSTPC_clusXY[i][2] = (TH2*) cl->getHisto(TPCMON_STR,"NorthSideADC_clusterXY_R3");
-
-    tpcmon_SSTPC_clusXY[i][0] = (TH2*) cl->getHisto(TPCMON_STR,"SouthSideADC_clusterXY_R1");
-    tpcmon_SSTPC_clusXY[i][1] = (TH2*) cl->getHisto(TPCMON_STR,"SouthSideADC_clusterXY_R2");
-    tpcmon_SSTPC_clusXY[i][2] = (TH2*) cl->getHisto(TPCMON_STR,"SouthSideADC_clusterXY_R3");
+    TH2 *clusXY[6] = {nullptr};
+    XYOverview(TPCMON_STR, {"NorthSideADC_clusterXY_R1", "NorthSideADC_clusterXY_R2", "NorthSideADC_clusterXY_R3", "SouthSideADC_clusterXY_R1", "SouthSideADC_clusterXY_R2", "SouthSideADC_clusterXY_R3"}, clusXY);
+    for (int j = 0; j < 3; j++)
+    {
+      tpcmon_NSTPC_clusXY[i][j] = clusXY[j];
+      tpcmon_SSTPC_clusXY[i][j] = clusXY[j + 3];
+    }
   }
 
   if (!gROOT->FindObject("TPCClusterXY"))
@@ -1198,13 +1266,13 @@ int TpcMonDraw::DrawTPCXYclusters_unweighted(const std::string & /* what */)
   {
     //const TString TPCMON_STR( Form( "TPCMON_%i", i ) );
     sprintf(TPCMON_STR,"TPCMON_%i",i);
-    tpcmon_NSTPC_clusXY[i][0] = (TH2*) cl->getHisto(TPCMON_STR,"NorthSideADC_clusterXY_R1_unw");
-    tpcmon_NSTPC_clusXY[i][1] = (TH2*) cl->getHisto(TPCMON_STR,"NorthSideADC_clusterXY_R2_unw");
-    tpcmon_NSTPC_clusXY[i][2] = (TH2*) cl->getHisto(TPCMON_STR,"NorthSideADC_clusterXY_R3_unw");
-
-    tpcmon_SSTPC_clusXY[i][0] = (TH2*) cl->getHisto(TPCMON_STR,"SouthSideADC_clusterXY_R1_unw");
-    tpcmon_SSTPC_clusXY[i][1] = (TH2*) cl->getHisto(TPCMON_STR,"SouthSideADC_clusterXY_R2_unw");
-    tpcmon_SSTPC_clusXY[i][2] = (TH2*) cl->getHisto(TPCMON_STR,"SouthSideADC_clusterXY_R3_unw");
+    TH2 *clusXY[6] = {nullptr};
+    XYOverview(TPCMON_STR, {"NorthSideADC_clusterXY_R1_unw", "NorthSideADC_clusterXY_R2_unw", "NorthSideADC_clusterXY_R3_unw", "SouthSideADC_clusterXY_R1_unw", "SouthSideADC_clusterXY_R2_unw", "SouthSideADC_clusterXY_R3_unw"}, clusXY);
+    for (int j = 0; j < 3; j++)
+    {
+      tpcmon_NSTPC_clusXY[i][j] = clusXY[j];
+      tpcmon_SSTPC_clusXY[i][j] = clusXY[j + 3];
+    }
   }
 
   if (!gROOT->FindObject("TPCClusterXY_unw"))
@@ -1385,22 +1453,12 @@ int TpcMonDraw::DrawTPCZYclusters(const std::string & /* what */)
 
   OnlMonClient *cl = OnlMonClient::instance();
 
-  TH2 *tpcmon_NSTPC_clusZY[24] = {nullptr};
-  TH2 *tpcmon_SSTPC_clusZY[24] = {nullptr};
-
   dummy_his1_ZY = new TH2F("dummy_his1_ZY", "(ADC-Pedestal) > 20 ADC, WEIGHTED", 515, -1030, 1030, 400, -800, 800); //dummy histos for titles
   dummy_his1_ZY->SetXTitle("Z [mm]");
   dummy_his1_ZY->SetYTitle("Y [mm]");
 
-  char TPCMON_STR[100];
-  for( int i=0; i<24; i++ ) 
-  {
-    //const TString TPCMON_STR( Form( "TPCMON_%i", i ) );
-    sprintf(TPCMON_STR,"TPCMON_%i",i);
-    tpcmon_NSTPC_clusZY[i] = (TH2*) cl->getHisto(TPCMON_STR,"NorthSideADC_clusterZY");
-
-    tpcmon_SSTPC_clusZY[i] = (TH2*) cl->getHisto(TPCMON_STR,"SouthSideADC_clusterZY");
-  }
+  // sum of the north and south sides of all servers, see Init()
+  TH2 *tpcmon_clusZY = (TH2*) cl->getHisto("TPCMON","ADC_clusterZY");
 
   if (!gROOT->FindObject("TPCClusterZY"))
   {
@@ -1432,39 +1490,12 @@ int TpcMonDraw::DrawTPCZYclusters(const std::string & /* what */)
   dummy_his1_ZY->Draw("colzsame");
 
 
-  float max = 0;
-  for( int i=0; i<12; i++ )
+  if( tpcmon_clusZY )
   {
-    if( tpcmon_NSTPC_clusZY[i] )
-    {
-      TC[13]->cd(1);
-      tpcmon_NSTPC_clusZY[i] -> Draw("colzsame");
-      if ( tpcmon_NSTPC_clusZY[i]->GetBinContent(tpcmon_NSTPC_clusZY[i]->GetMaximumBin()) > max ) 
-      {
-        max = tpcmon_NSTPC_clusZY[i]->GetBinContent(tpcmon_NSTPC_clusZY[i]->GetMaximumBin());
-        dummy_his1_ZY->SetMaximum( max );
-      }
-      gStyle->SetPalette(57); //kBird CVD friendly
-    }
-
-  }
-  TC[13]->Update();
-
-  for( int i=0; i<12; i++ )
-  {
-    if( tpcmon_SSTPC_clusZY[i+12] )
-    {
-      TC[13]->cd(1);
-      tpcmon_SSTPC_clusZY[i+12] -> Draw("colzsame");
-      if ( tpcmon_SSTPC_clusZY[i+12]->GetBinContent(tpcmon_SSTPC_clusZY[i+12]->GetMaximumBin()) > max ) 
-      {
-        max = tpcmon_SSTPC_clusZY[i+12]->GetBinContent(tpcmon_SSTPC_clusZY[i+12]->GetMaximumBin());
-        dummy_his1_ZY->SetMaximum( max );
-      }
-      //gStyle->SetLogz(kTRUE);
-      gStyle->SetPalette(57); //kBird CVD friendly
-    }
-
+    TC[13]->cd(1);
+    tpcmon_clusZY -> Draw("colzsame");
+    dummy_his1_ZY->SetMaximum( tpcmon_clusZY->GetBinContent(tpcmon_clusZY->GetMaximumBin()) );
+    gStyle->SetPalette(57); //kBird CVD friendly
   }
 
   TC[13]->Update();
@@ -1483,22 +1514,12 @@ int TpcMonDraw::DrawTPCZYclusters_unweighted(const std::string & /* what */)
 
   OnlMonClient *cl = OnlMonClient::instance();
 
-  TH2 *tpcmon_NSTPC_clusZY_unw[24] = {nullptr};
-  TH2 *tpcmon_SSTPC_clusZY_unw[24] = {nullptr};
-
   dummy_his1_ZY_unw = new TH2F("dummy_his1_ZY_unw", "(ADC-Pedestal) > 20 ADC, UNWEIGHTED", 515, -1030, 1030, 400, -800, 800); //dummy histos for titles
   dummy_his1_ZY_unw->SetXTitle("Z [mm]");
   dummy_his1_ZY_unw->SetYTitle("Y [mm]");
 
-  char TPCMON_STR[100];
-  for( int i=0; i<24; i++ ) 
-  {
-    //const TString TPCMON_STR( Form( "TPCMON_%i", i ) );
-    sprintf(TPCMON_STR,"TPCMON_%i",i);
-    tpcmon_NSTPC_clusZY_unw[i] = (TH2*) cl->getHisto(TPCMON_STR,"NorthSideADC_clusterZY_unw");
-
-    tpcmon_SSTPC_clusZY_unw[i] = (TH2*) cl->getHisto(TPCMON_STR,"SouthSideADC_clusterZY_unw");
-  }
+  // sum of the north and south sides of all servers, see Init()
+  TH2 *tpcmon_clusZY_unw = (TH2*) cl->getHisto("TPCMON","ADC_clusterZY_unw");
 
   if (!gROOT->FindObject("TPCClusterZY_unw"))
   {
@@ -1529,40 +1550,12 @@ int TpcMonDraw::DrawTPCZYclusters_unweighted(const std::string & /* what */)
   gPad->SetLogz(kTRUE);
   dummy_his1_ZY_unw->Draw("colzsame");
 
-  float max = 0;
-  for( int i=0; i<12; i++ )
+  if( tpcmon_clusZY_unw )
   {
-    if( tpcmon_NSTPC_clusZY_unw[i] )
-    {
-      TC[14]->cd(1);
-      tpcmon_NSTPC_clusZY_unw[i] -> Draw("colzsame");
-      if ( tpcmon_NSTPC_clusZY_unw[i]->GetBinContent(tpcmon_NSTPC_clusZY_unw[i]->GetMaximumBin()) > max ) 
-      {
-        max = tpcmon_NSTPC_clusZY_unw[i]->GetBinContent(tpcmon_NSTPC_clusZY_unw[i]->GetMaximumBin());
-        dummy_his1_ZY->SetMaximum( max );
-      }
-      //gStyle->SetLogz(kTRUE);
-      gStyle->SetPalette(57); //kBird CVD friendly
-    }
-
-  }
-  TC[14]->Update();
-
-  for( int i=0; i<12; i++ )
-  {
-    if( tpcmon_SSTPC_clusZY_unw[i+12] )
-    {
-      TC[14]->cd(1);
-      tpcmon_SSTPC_clusZY_unw[i+12] -> Draw("colzsame");
-      if ( tpcmon_SSTPC_clusZY_unw[i+12]->GetBinContent(tpcmon_SSTPC_clusZY_unw[i+12]->GetMaximumBin()) > max ) 
-      {
-        max = tpcmon_SSTPC_clusZY_unw[i+12]->GetBinContent(tpcmon_SSTPC_clusZY_unw[i+12]->GetMaximumBin());
-        dummy_his1_ZY->SetMaximum( max );
-      }
-      //gStyle->SetLogz(kTRUE);
-      gStyle->SetPalette(57); //kBird CVD friendly
-    }
-
+    TC[14]->cd(1);
+    tpcmon_clusZY_unw -> Draw("colzsame");
+    dummy_his1_ZY_unw->SetMaximum( tpcmon_clusZY_unw->GetBinContent(tpcmon_clusZY_unw->GetMaximumBin()) );
+    gStyle->SetPalette(57); //kBird CVD friendly
   }
   TC[14]->Update();
 
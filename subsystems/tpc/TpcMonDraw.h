@@ -3,7 +3,9 @@
 
 #include <onlmon/OnlMonDraw.h>
 
+#include <map>
 #include <string>  // for allocator, string
+#include <vector>
 
 class TCanvas;
 class TGraphErrors;
@@ -22,6 +24,10 @@ class TpcMonDraw : public OnlMonDraw
   int Draw(const std::string &what = "ALL") override;
   int MakeHtml(const std::string &what = "ALL") override;
   int SavePlot(const std::string &what = "ALL", const std::string &type = "png") override;
+  int HistoVersions(const std::string &what, std::map<std::string, unsigned int> &versions) override;
+  // bins of the x-y cluster maps combined per axis, 1 draws them at full
+  // resolution for zooming into them (default 2 for the overview)
+  void XYRebin(const int i) { m_XYRebin = i; }
 
  protected:
   int MakeCanvas(const std::string &name);
@@ -39,6 +45,9 @@ class TpcMonDraw : public OnlMonDraw
   int DrawTPCXYclusters_unweighted(const std::string &what = "ALL");
   int DrawTPCZYclusters(const std::string &what = "ALL");
   int DrawTPCZYclusters_unweighted(const std::string &what = "ALL");
+  // x-y cluster maps of one server at the resolution of the overview, all of
+  // them in one request to the server
+  void XYOverview(const std::string &monitor, const std::vector<std::string> &hnames, TH2 *histos[]);
   time_t getTime();
   
   TCanvas *TC[15] = {nullptr};
@@ -85,6 +94,8 @@ class TpcMonDraw : public OnlMonDraw
   TPaveLabel* SS09 = nullptr;
   TPaveLabel* SS10 = nullptr;
   TPaveLabel* SS11 = nullptr;
+
+  int m_XYRebin = 2;
 };
 
 #endif /* TPC_TPCMONDRAW_H */